@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_allocation_scaling.dir/bench_allocation_scaling.cpp.o"
+  "CMakeFiles/bench_allocation_scaling.dir/bench_allocation_scaling.cpp.o.d"
+  "bench_allocation_scaling"
+  "bench_allocation_scaling.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_allocation_scaling.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
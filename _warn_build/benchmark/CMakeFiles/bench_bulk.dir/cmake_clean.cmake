@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_bulk.dir/bench_bulk.cpp.o"
+  "CMakeFiles/bench_bulk.dir/bench_bulk.cpp.o.d"
+  "bench_bulk"
+  "bench_bulk.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_bulk.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_dso.dir/bench_dso.cpp.o"
+  "CMakeFiles/bench_dso.dir/bench_dso.cpp.o.d"
+  "bench_dso"
+  "bench_dso.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_dso.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_dso_plugin.dir/bench_dso_plugin.cpp.o"
+  "CMakeFiles/bench_dso_plugin.dir/bench_dso_plugin.cpp.o.d"
+  "libbench_dso_plugin.pdb"
+  "libbench_dso_plugin.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_dso_plugin.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_memoized.dir/bench_memoized.cpp.o"
+  "CMakeFiles/bench_memoized.dir/bench_memoized.cpp.o.d"
+  "bench_memoized"
+  "bench_memoized.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_memoized.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
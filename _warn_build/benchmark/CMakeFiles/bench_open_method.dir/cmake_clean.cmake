@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_open_method.dir/bench_open_method.cpp.o"
+  "CMakeFiles/bench_open_method.dir/bench_open_method.cpp.o.d"
+  "bench_open_method"
+  "bench_open_method.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_open_method.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_persistent_vector.dir/bench_persistent_vector.cpp.o"
+  "CMakeFiles/bench_persistent_vector.dir/bench_persistent_vector.cpp.o.d"
+  "bench_persistent_vector"
+  "bench_persistent_vector.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_persistent_vector.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
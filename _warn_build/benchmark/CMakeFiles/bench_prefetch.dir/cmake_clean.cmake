@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_prefetch.dir/bench_prefetch.cpp.o"
+  "CMakeFiles/bench_prefetch.dir/bench_prefetch.cpp.o.d"
+  "bench_prefetch"
+  "bench_prefetch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_prefetch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_profiled.dir/bench_profiled.cpp.o"
+  "CMakeFiles/bench_profiled.dir/bench_profiled.cpp.o.d"
+  "bench_profiled"
+  "bench_profiled.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_profiled.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_workloads.dir/bench_workloads.cpp.o"
+  "CMakeFiles/bench_workloads.dir/bench_workloads.cpp.o.d"
+  "bench_workloads"
+  "bench_workloads.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_workloads.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
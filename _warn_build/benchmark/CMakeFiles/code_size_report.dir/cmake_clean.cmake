@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/code_size_report"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/code_size_report.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/compile_time_benchmark"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/compile_time_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/type_erasure_example.dir/type_erasure_example.cpp.o"
+  "CMakeFiles/type_erasure_example.dir/type_erasure_example.cpp.o.d"
+  "type_erasure_example"
+  "type_erasure_example.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/type_erasure_example.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
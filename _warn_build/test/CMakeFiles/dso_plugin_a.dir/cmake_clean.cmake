@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/dso_plugin_a.dir/dso_plugin.cpp.o"
+  "CMakeFiles/dso_plugin_a.dir/dso_plugin.cpp.o.d"
+  "libdso_plugin_a.pdb"
+  "libdso_plugin_a.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/dso_plugin_a.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
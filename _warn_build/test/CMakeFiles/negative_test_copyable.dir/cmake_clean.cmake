@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/negative_test_copyable.dir/test_type_erasure_movable.cpp.o"
+  "CMakeFiles/negative_test_copyable.dir/test_type_erasure_movable.cpp.o.d"
+  "negative_test_copyable"
+  "negative_test_copyable.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/negative_test_copyable.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
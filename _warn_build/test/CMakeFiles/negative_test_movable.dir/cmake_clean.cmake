@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/negative_test_movable.dir/test_type_erasure_movable.cpp.o"
+  "CMakeFiles/negative_test_movable.dir/test_type_erasure_movable.cpp.o.d"
+  "negative_test_movable"
+  "negative_test_movable.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/negative_test_movable.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_buffer_advisor.dir/test_buffer_advisor.cpp.o"
+  "CMakeFiles/test_buffer_advisor.dir/test_buffer_advisor.cpp.o.d"
+  "test_buffer_advisor"
+  "test_buffer_advisor.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_buffer_advisor.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
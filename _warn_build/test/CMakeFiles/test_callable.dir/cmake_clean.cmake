@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_callable.dir/test_callable.cpp.o"
+  "CMakeFiles/test_callable.dir/test_callable.cpp.o.d"
+  "test_callable"
+  "test_callable.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_callable.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
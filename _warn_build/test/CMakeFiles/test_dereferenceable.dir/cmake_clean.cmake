@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_dereferenceable.dir/test_dereferenceable.cpp.o"
+  "CMakeFiles/test_dereferenceable.dir/test_dereferenceable.cpp.o.d"
+  "test_dereferenceable"
+  "test_dereferenceable.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_dereferenceable.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_dso.dir/test_dso.cpp.o"
+  "CMakeFiles/test_dso.dir/test_dso.cpp.o.d"
+  "test_dso"
+  "test_dso.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_dso.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
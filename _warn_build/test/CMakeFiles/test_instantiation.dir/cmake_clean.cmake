@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_instantiation.dir/test_instantiation.cpp.o"
+  "CMakeFiles/test_instantiation.dir/test_instantiation.cpp.o.d"
+  "CMakeFiles/test_instantiation.dir/test_instantiation_models.cpp.o"
+  "CMakeFiles/test_instantiation.dir/test_instantiation_models.cpp.o.d"
+  "test_instantiation"
+  "test_instantiation.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_instantiation.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
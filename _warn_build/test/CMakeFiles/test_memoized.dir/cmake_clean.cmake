@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_memoized.dir/test_memoized.cpp.o"
+  "CMakeFiles/test_memoized.dir/test_memoized.cpp.o.d"
+  "test_memoized"
+  "test_memoized.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_memoized.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
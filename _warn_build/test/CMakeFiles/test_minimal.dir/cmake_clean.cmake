@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_minimal.dir/test_minimal.cpp.o"
+  "CMakeFiles/test_minimal.dir/test_minimal.cpp.o.d"
+  "test_minimal"
+  "test_minimal.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_minimal.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_open_method.dir/test_open_method.cpp.o"
+  "CMakeFiles/test_open_method.dir/test_open_method.cpp.o.d"
+  "test_open_method"
+  "test_open_method.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_open_method.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_persistent_vector.dir/test_persistent_vector.cpp.o"
+  "CMakeFiles/test_persistent_vector.dir/test_persistent_vector.cpp.o.d"
+  "test_persistent_vector"
+  "test_persistent_vector.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_persistent_vector.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_pointer_like.dir/test_pointer_like.cpp.o"
+  "CMakeFiles/test_pointer_like.dir/test_pointer_like.cpp.o.d"
+  "test_pointer_like"
+  "test_pointer_like.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_pointer_like.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
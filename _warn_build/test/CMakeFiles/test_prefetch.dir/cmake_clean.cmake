@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_prefetch.dir/test_prefetch.cpp.o"
+  "CMakeFiles/test_prefetch.dir/test_prefetch.cpp.o.d"
+  "test_prefetch"
+  "test_prefetch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_prefetch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
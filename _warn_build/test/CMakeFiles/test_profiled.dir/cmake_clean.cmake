@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_profiled.dir/test_profiled.cpp.o"
+  "CMakeFiles/test_profiled.dir/test_profiled.cpp.o.d"
+  "test_profiled"
+  "test_profiled.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_profiled.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
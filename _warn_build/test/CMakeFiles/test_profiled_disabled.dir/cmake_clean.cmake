@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_profiled_disabled.dir/test_profiled.cpp.o"
+  "CMakeFiles/test_profiled_disabled.dir/test_profiled.cpp.o.d"
+  "test_profiled_disabled"
+  "test_profiled_disabled.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_profiled_disabled.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
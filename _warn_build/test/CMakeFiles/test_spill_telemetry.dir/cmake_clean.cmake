@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_spill_telemetry.dir/test_spill_telemetry.cpp.o"
+  "CMakeFiles/test_spill_telemetry.dir/test_spill_telemetry.cpp.o.d"
+  "test_spill_telemetry"
+  "test_spill_telemetry.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_spill_telemetry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_type_erasure_movable.dir/test_type_erasure_movable.cpp.o"
+  "CMakeFiles/test_type_erasure_movable.dir/test_type_erasure_movable.cpp.o.d"
+  "test_type_erasure_movable"
+  "test_type_erasure_movable.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_type_erasure_movable.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,54 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test
+# Build directory: /root/repo/_warn_build/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_type_erasure_movable "/root/repo/_warn_build/test/test_type_erasure_movable")
+set_tests_properties(test_type_erasure_movable PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;10;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_meta "/root/repo/_warn_build/test/test_meta")
+set_tests_properties(test_meta PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;14;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(negative_test_copyable "/usr/bin/cmake" "--build" "." "--target" "negative_test_copyable" "--config" "")
+set_tests_properties(negative_test_copyable PROPERTIES  WILL_FAIL "TRUE" WORKING_DIRECTORY "/root/repo/_warn_build" _BACKTRACE_TRIPLES "/root/repo/CMake/assert_build_fails.cmake;37;add_test;/root/repo/test/CMakeLists.txt;16;assert_build_fails;/root/repo/test/CMakeLists.txt;0;")
+add_test(negative_test_movable "/usr/bin/cmake" "--build" "." "--target" "negative_test_movable" "--config" "")
+set_tests_properties(negative_test_movable PROPERTIES  WILL_FAIL "TRUE" WORKING_DIRECTORY "/root/repo/_warn_build" _BACKTRACE_TRIPLES "/root/repo/CMake/assert_build_fails.cmake;37;add_test;/root/repo/test/CMakeLists.txt;25;assert_build_fails;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_dereferenceable "/root/repo/_warn_build/test/test_dereferenceable")
+set_tests_properties(test_dereferenceable PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;37;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_callable "/root/repo/_warn_build/test/test_callable")
+set_tests_properties(test_callable PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;42;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_minimal "/root/repo/_warn_build/test/test_minimal")
+set_tests_properties(test_minimal PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;46;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_layout "/root/repo/_warn_build/test/test_layout")
+set_tests_properties(test_layout PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;51;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_trace "/root/repo/_warn_build/test/test_trace")
+set_tests_properties(test_trace PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;56;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_allocations "/root/repo/_warn_build/test/test_allocations")
+set_tests_properties(test_allocations PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;62;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_profiled "/root/repo/_warn_build/test/test_profiled")
+set_tests_properties(test_profiled PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;68;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_profiled_disabled "/root/repo/_warn_build/test/test_profiled_disabled")
+set_tests_properties(test_profiled_disabled PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;72;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_spill_telemetry "/root/repo/_warn_build/test/test_spill_telemetry")
+set_tests_properties(test_spill_telemetry PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;78;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_buffer_advisor "/root/repo/_warn_build/test/test_buffer_advisor")
+set_tests_properties(test_buffer_advisor PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;84;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_pointer_like "/root/repo/_warn_build/test/test_pointer_like")
+set_tests_properties(test_pointer_like PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;90;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_arena "/root/repo/_warn_build/test/test_arena")
+set_tests_properties(test_arena PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;96;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_bulk "/root/repo/_warn_build/test/test_bulk")
+set_tests_properties(test_bulk PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;102;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_prefetch "/root/repo/_warn_build/test/test_prefetch")
+set_tests_properties(test_prefetch PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;107;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_memoized "/root/repo/_warn_build/test/test_memoized")
+set_tests_properties(test_memoized PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;113;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_open_method "/root/repo/_warn_build/test/test_open_method")
+set_tests_properties(test_open_method PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;119;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_persistent_vector "/root/repo/_warn_build/test/test_persistent_vector")
+set_tests_properties(test_persistent_vector PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;125;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_dso "/root/repo/_warn_build/test/test_dso" "/root/repo/_warn_build/test/libdso_plugin_a.so" "/root/repo/_warn_build/test/libdso_plugin_b.so")
+set_tests_properties(test_dso PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;137;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_instantiation "/root/repo/_warn_build/test/test_instantiation")
+set_tests_properties(test_instantiation PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;145;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(code_size_trivial_feature "/root/.pyenv/shims/python3" "/root/repo/benchmark/code_size/code_size.py" "--check" "--compiler" "/usr/bin/c++" "--include" "/root/repo" "--work-dir" "/root/repo/_warn_build/test/code_size")
+set_tests_properties(code_size_trivial_feature PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;164;add_test;/root/repo/test/CMakeLists.txt;0;")
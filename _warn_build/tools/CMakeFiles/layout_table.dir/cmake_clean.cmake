@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/layout_table.dir/layout_table.cpp.o"
+  "CMakeFiles/layout_table.dir/layout_table.cpp.o.d"
+  "layout_table"
+  "layout_table.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/layout_table.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,303 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Multi-threaded allocation scaling of erased values.
+ *
+ * Two patterns are run at 1, 2, 4, ... up to --max-threads (default 128)
+ * threads:
+ * - churn: every thread constructs a batch of anys and destroys it again.
+ *   Allocation and deallocation happen on the same thread.
+ * - producer/consumer: half the threads construct anys into a ring shared
+ *   with one consumer each, which destroys them. Every spilled model is freed
+ *   on a different thread than the one that allocated it.
+ *
+ * Each pattern runs for `function<int(int)>` and `any<regular>` holding a
+ * 64-byte payload, once per storage strategy: `malloc` (the default
+ * buffer_size, every model spills to the heap) and `inline` (a buffer_size
+ * large enough to hold the model, no allocation at all). The inline row is
+ * the floor that any storage change is trying to reach.
+ *
+ * Reported are objects per second over all threads, and p50/p99/p999 of the
+ * construct and destroy latency in ns, sampled every --sample-every
+ * operations (the clock read is included in the sample).
+ *
+ * Options: --max-threads=N --ops=N (per thread) --sample-every=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace f = erasure::features;
+using bench_util::now_ns;
+
+struct payload {
+  std::array<std::uint64_t, 8> words{};
+  friend auto operator==(payload const &x, payload const &y) -> bool {
+    return x.words == y.words;
+  }
+};
+
+/** Large enough for a model holding a payload: vptr + 64 bytes. */
+constexpr std::size_t inline_size = sizeof(void *) + sizeof(payload);
+
+struct malloc_storage {
+  static constexpr char const *name = "malloc";
+  static constexpr std::size_t buffer = 0;
+};
+struct inline_storage {
+  static constexpr char const *name = "inline";
+  static constexpr std::size_t buffer = inline_size;
+};
+
+template <typename Storage>
+struct function_case {
+  static constexpr char const *name = "function<int(int)>";
+  using any_type = erasure::any<f::function<int(int), Storage::buffer>>;
+  static void emplace(std::optional<any_type> &slot, std::uint64_t i) {
+    payload p;
+    p.words[0] = i;
+    slot.emplace([p](int x) { return x + static_cast<int>(p.words[0]); });
+  }
+};
+
+template <typename Storage>
+struct regular_case {
+  static constexpr char const *name = "any<regular>";
+  using any_type = erasure::any<f::regular, f::buffer_size<Storage::buffer>>;
+  static void emplace(std::optional<any_type> &slot, std::uint64_t i) {
+    payload p;
+    p.words[0] = i;
+    slot.emplace(p);
+  }
+};
+
+struct thread_samples {
+  std::vector<std::uint64_t> construct;
+  std::vector<std::uint64_t> destroy;
+};
+
+struct run_result {
+  double objects_per_second = 0;
+  bench_util::latency_summary construct;
+  bench_util::latency_summary destroy;
+};
+
+struct config {
+  std::uint64_t ops;
+  std::uint64_t sample_every;
+};
+
+/** Worker threads spin here until the main thread starts the clock. */
+struct start_line {
+  explicit start_line(std::size_t workers) : waiting(workers + 1) {}
+  void arrive_and_wait() {
+    waiting.fetch_sub(1);
+    while (waiting.load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+  /** Waits for all workers, then releases them; returns the start time. */
+  auto release() -> std::uint64_t {
+    while (waiting.load() != 1) {
+      std::this_thread::yield();
+    }
+    auto const start = now_ns();
+    waiting.store(0);
+    return start;
+  }
+  std::atomic<std::size_t> waiting;
+};
+
+template <typename F>
+void timed(bool sample, std::vector<std::uint64_t> &into, F &&f) {
+  if (sample) {
+    auto const start = now_ns();
+    f();
+    into.push_back(now_ns() - start);
+  } else {
+    f();
+  }
+}
+
+auto merge(std::vector<thread_samples> &per_thread, double seconds,
+           std::uint64_t objects) -> run_result {
+  std::vector<std::uint64_t> construct, destroy;
+  for (auto &s : per_thread) {
+    construct.insert(construct.end(), s.construct.begin(), s.construct.end());
+    destroy.insert(destroy.end(), s.destroy.begin(), s.destroy.end());
+  }
+  run_result r;
+  r.objects_per_second = objects / seconds;
+  r.construct = bench_util::summarize(construct);
+  r.destroy = bench_util::summarize(destroy);
+  return r;
+}
+
+template <typename Case>
+auto churn(std::size_t threads, config const &cfg) -> run_result {
+  using any_type = typename Case::any_type;
+  constexpr std::size_t batch = 64;
+  std::vector<thread_samples> samples(threads);
+  start_line start{threads};
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      auto &s = samples[t];
+      std::vector<std::optional<any_type>> slots(batch);
+      std::uint64_t op = 0;
+      start.arrive_and_wait();
+      while (op < cfg.ops) {
+        for (auto &slot : slots) {
+          timed(op % cfg.sample_every == 0, s.construct,
+                [&] { Case::emplace(slot, op); });
+          ++op;
+        }
+        for (std::size_t i = 0; i < batch; ++i) {
+          timed((op - batch + i) % cfg.sample_every == 0, s.destroy,
+                [&] { slots[i].reset(); });
+        }
+      }
+    });
+  }
+  auto const begin = start.release();
+  for (auto &w : workers) {
+    w.join();
+  }
+  auto const seconds = (now_ns() - begin) * 1e-9;
+  std::uint64_t const per_thread = (cfg.ops + batch - 1) / batch * batch;
+  return merge(samples, seconds, per_thread * threads);
+}
+
+/** A single-producer single-consumer ring of in-place constructed anys. */
+template <typename Any>
+struct handoff_ring {
+  struct slot {
+    std::atomic<bool> full{false};
+    std::optional<Any> value;
+  };
+  explicit handoff_ring(std::size_t n) : slots(n) {}
+  std::vector<slot> slots;
+};
+
+template <typename Case>
+auto producer_consumer(std::size_t threads, config const &cfg) -> run_result {
+  using any_type = typename Case::any_type;
+  auto const pairs = threads / 2;
+  std::vector<thread_samples> samples(pairs * 2);
+  std::vector<handoff_ring<any_type>> rings;
+  rings.reserve(pairs);
+  for (std::size_t p = 0; p < pairs; ++p) {
+    rings.emplace_back(256);
+  }
+  start_line start{pairs * 2};
+  std::vector<std::thread> workers;
+  for (std::size_t p = 0; p < pairs; ++p) {
+    workers.emplace_back([&, p] { // producer
+      auto &s = samples[2 * p];
+      auto &ring = rings[p];
+      start.arrive_and_wait();
+      for (std::uint64_t op = 0; op < cfg.ops; ++op) {
+        auto &slot = ring.slots[op % ring.slots.size()];
+        while (slot.full.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        timed(op % cfg.sample_every == 0, s.construct,
+              [&] { Case::emplace(slot.value, op); });
+        slot.full.store(true, std::memory_order_release);
+      }
+    });
+    workers.emplace_back([&, p] { // consumer
+      auto &s = samples[2 * p + 1];
+      auto &ring = rings[p];
+      start.arrive_and_wait();
+      for (std::uint64_t op = 0; op < cfg.ops; ++op) {
+        auto &slot = ring.slots[op % ring.slots.size()];
+        while (!slot.full.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        timed(op % cfg.sample_every == 0, s.destroy,
+              [&] { slot.value.reset(); });
+        slot.full.store(false, std::memory_order_release);
+      }
+    });
+  }
+  auto const begin = start.release();
+  for (auto &w : workers) {
+    w.join();
+  }
+  auto const seconds = (now_ns() - begin) * 1e-9;
+  return merge(samples, seconds, cfg.ops * pairs);
+}
+
+void print_header() {
+  std::cout << std::left << std::setw(18) << "pattern" << std::setw(20)
+            << "type" << std::setw(8) << "storage" << std::right
+            << std::setw(8) << "threads" << std::setw(10) << "Mobj/s"
+            << "   construct p50/p99/p999" << "   destroy p50/p99/p999\n";
+}
+
+template <typename Case, typename Storage>
+void report(char const *pattern, std::size_t threads, run_result const &r) {
+  std::cout << std::left << std::setw(18) << pattern << std::setw(20)
+            << Case::name << std::setw(8) << Storage::name << std::right
+            << std::setw(8) << threads << std::setw(10) << std::fixed
+            << std::setprecision(2) << r.objects_per_second * 1e-6 << "   "
+            << r.construct << "         " << r.destroy << "\n";
+}
+
+template <template <typename> class Case, typename Storage>
+void run_all(std::uint64_t max_threads, config const &cfg) {
+  using case_type = Case<Storage>;
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    report<case_type, Storage>("churn", threads,
+                               churn<case_type>(threads, cfg));
+  }
+  for (std::size_t threads = 2; threads <= max_threads; threads *= 2) {
+    report<case_type, Storage>("producer/consumer", threads,
+                               producer_consumer<case_type>(threads, cfg));
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const max_threads = opts.get("max-threads", std::uint64_t{128});
+  config const cfg{opts.get("ops", std::uint64_t{20000}),
+                   std::max<std::uint64_t>(1, opts.get("sample-every",
+                                                       std::uint64_t{8}))};
+
+  print_header();
+  run_all<function_case, malloc_storage>(max_threads, cfg);
+  run_all<function_case, inline_storage>(max_threads, cfg);
+  run_all<regular_case, malloc_storage>(max_threads, cfg);
+  run_all<regular_case, inline_storage>(max_threads, cfg);
+}
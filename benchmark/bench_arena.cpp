@@ -0,0 +1,137 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Memory and speed of a column of erased int64s.
+ *
+ * Fills a column of --elements (default 100M) `any<regular>` int64s, stored
+ * as 32-bit handles into an `arena`, as anys with a 16 byte buffer, and as
+ * anys with every model on the heap, in that order. Reported are the resident
+ * bytes per element, ns per element to fill the column, and ns per element
+ * to compare every element with its neighbour through the vtable.
+ *
+ * Resident bytes are read from /proc/self/statm, and are 0 elsewhere.
+ *
+ * Options: --elements=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/arena.hpp"
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+namespace f = erasure::features;
+
+auto resident_bytes() -> std::size_t {
+#if defined(__unix__)
+  std::ifstream statm("/proc/self/statm");
+  std::size_t pages = 0, resident = 0;
+  if (statm >> pages >> resident) {
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  }
+#endif
+  return 0;
+}
+
+struct result {
+  double bytes, fill, compare;
+};
+
+void print(char const *name, result const &r) {
+  std::cout << std::setw(18) << name << std::setw(12) << r.bytes
+            << std::setw(12) << r.fill << std::setw(12) << r.compare << '\n';
+}
+
+auto run_arena(std::size_t elements) -> result {
+  using value = erasure::any<f::regular>;
+  auto const n = static_cast<double>(elements);
+  auto const before = resident_bytes();
+  auto start = bench_util::now_ns();
+  // room for every model, but only the pages filled are resident
+  erasure::arena<value> arena((elements + 1) * 16);
+  std::vector<erasure::arena_any<value>> column;
+  column.reserve(elements);
+  for (std::size_t i = 0; i < elements; ++i) {
+    column.push_back(arena.emplace(static_cast<std::int64_t>(i % 7)));
+  }
+  bench_util::clobber_memory();
+  auto const fill = static_cast<double>(bench_util::now_ns() - start);
+  auto const bytes = static_cast<double>(resident_bytes() - before);
+
+  start = bench_util::now_ns();
+  std::size_t equal = 0;
+  for (std::size_t i = 1; i < elements; ++i) {
+    equal += arena.same_dynamic_type(column[i], column[i - 1]) &&
+             arena.call<f::equality_comparable>(
+                 column[i], *arena.concept_ptr(column[i - 1]));
+  }
+  bench_util::do_not_optimize(equal);
+  auto const compare = static_cast<double>(bench_util::now_ns() - start);
+  return {bytes / n, fill / n, compare / n};
+}
+
+template <typename Any>
+auto run_anys(std::size_t elements) -> result {
+  auto const n = static_cast<double>(elements);
+  auto const before = resident_bytes();
+  auto start = bench_util::now_ns();
+  std::vector<Any> column;
+  column.reserve(elements);
+  for (std::size_t i = 0; i < elements; ++i) {
+    column.emplace_back(static_cast<std::int64_t>(i % 7));
+  }
+  bench_util::clobber_memory();
+  auto const fill = static_cast<double>(bench_util::now_ns() - start);
+  auto const bytes = static_cast<double>(resident_bytes() - before);
+
+  start = bench_util::now_ns();
+  std::size_t equal = 0;
+  for (std::size_t i = 1; i < elements; ++i) {
+    equal += column[i] == column[i - 1];
+  }
+  bench_util::do_not_optimize(equal);
+  auto const compare = static_cast<double>(bench_util::now_ns() - start);
+  return {bytes / n, fill / n, compare / n};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const elements = opts.get("elements", std::uint64_t{100000000});
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(18) << "layout" << std::setw(12) << "bytes/elem"
+            << std::setw(12) << "fill ns" << std::setw(12) << "compare ns"
+            << '\n';
+  print("arena", run_arena(elements));
+  print("buffer_size<16>",
+        run_anys<erasure::any<f::regular, f::buffer_size<16>>>(elements));
+  print("heap", run_anys<erasure::any<f::regular>>(elements));
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Bulk construction and copying of anys.
+ *
+ * For `any<regular>` holding a trivially copyable 32 byte struct and a
+ * std::string, both spilled to the heap, prints the ns per element to make
+ * --count anys from a vector of values and to copy the vector of anys, once
+ * element by element and once with make_anys and clone_range, and to destroy
+ * what each made.
+ *
+ * Options: --count=N --repeat=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/bulk.hpp"
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace f = erasure::features;
+using value = erasure::any<f::regular>;
+
+struct quad {
+  std::array<std::int64_t, 4> xs;
+  friend auto operator==(quad const &, quad const &) -> bool = default;
+};
+
+/** ns per element of make(), and of destroying what it made. */
+template <typename Make>
+auto time(std::size_t count, std::size_t repeat, Make make)
+    -> std::pair<double, double> {
+  double made = 0, destroyed = 0;
+  for (std::size_t i = 0; i < repeat; ++i) {
+    auto start = bench_util::now_ns();
+    auto xs = make();
+    bench_util::clobber_memory();
+    auto stop = bench_util::now_ns();
+    made += static_cast<double>(stop - start);
+    start = bench_util::now_ns();
+    xs = {};
+    bench_util::clobber_memory();
+    stop = bench_util::now_ns();
+    destroyed += static_cast<double>(stop - start);
+  }
+  auto const n = static_cast<double>(count * repeat);
+  return {made / n, destroyed / n};
+}
+
+void print(char const *name, std::pair<double, double> loop,
+           std::pair<double, double> bulk) {
+  std::cout << std::setw(14) << name << std::setw(10) << loop.first
+            << std::setw(10) << bulk.first << std::setw(12) << loop.second
+            << std::setw(12) << bulk.second << '\n';
+}
+
+template <typename T>
+void run(char const *name, std::vector<T> const &values, std::size_t repeat) {
+  auto const count = values.size();
+  auto const make_loop = [&] {
+    std::vector<value> xs;
+    xs.reserve(count);
+    for (auto const &v : values) {
+      xs.emplace_back(v);
+    }
+    return xs;
+  };
+  auto const make_bulk = [&] {
+    return erasure::make_anys<f::regular>(values.begin(), values.end());
+  };
+  print((std::string(name) + " make").c_str(),
+        time(count, repeat, make_loop), time(count, repeat, make_bulk));
+
+  auto const anys = make_loop();
+  auto const copy_loop = [&] {
+    std::vector<value> xs;
+    xs.reserve(count);
+    for (auto const &x : anys) {
+      xs.push_back(x);
+    }
+    return xs;
+  };
+  auto const copy_bulk = [&] {
+    std::vector<value> xs;
+    erasure::clone_range(anys, xs);
+    return xs;
+  };
+  print((std::string(name) + " copy").c_str(),
+        time(count, repeat, copy_loop), time(count, repeat, copy_bulk));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const count = opts.get("count", std::uint64_t{1000000});
+  auto const repeat = opts.get("repeat", std::uint64_t{10});
+
+  std::vector<quad> quads;
+  std::vector<std::string> strings;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const n = static_cast<std::int64_t>(i);
+    quads.push_back(quad{{n, n + 1, n + 2, n + 3}});
+    strings.push_back(std::string(40, static_cast<char>('a' + i % 26)));
+  }
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(14) << "ns/element" << std::setw(10) << "loop"
+            << std::setw(10) << "bulk" << std::setw(12) << "loop free"
+            << std::setw(12) << "bulk free" << '\n';
+  run("quad", quads, repeat);
+  run("string", strings, repeat);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Type identity of anys made in a plugin.
+ *
+ * Loads bench_dso_plugin, built with hidden visibility, with dlopen and
+ * RTLD_LOCAL, and has it and this program make --elements anys each,
+ * alternating two value types. For both, prints the ns per element to test
+ * each against a point made here with same_dynamic_type and target<point>,
+ * and with what they did before: comparing typeids and dynamic_cast.
+ *
+ * Options: --elements=N --repeat=N --plugin=PATH (defaults to the one built
+ * alongside)
+ */
+
+#include "bench_util.hpp"
+
+#include "bench_dso.hpp"
+
+#include <dlfcn.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using bench_dso::point;
+using bench_dso::value;
+using point_model = erasure::detail::ifc_model<value const &, point>;
+
+template <typename Test>
+auto ns_per_element(std::vector<value> const &xs, std::size_t repeat,
+                    Test test) -> double {
+  std::size_t yes = 0;
+  auto const start = bench_util::now_ns();
+  for (std::size_t i = 0; i < repeat; ++i) {
+    for (auto const &x : xs) {
+      yes += test(x);
+    }
+  }
+  auto const stop = bench_util::now_ns();
+  bench_util::do_not_optimize(yes);
+  return static_cast<double>(stop - start) /
+         static_cast<double>(xs.size() * repeat);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const elements = opts.get("elements", std::uint64_t{1000000});
+  auto const repeat = opts.get("repeat", std::uint64_t{10});
+  auto const path = opts.get("plugin", std::string(BENCH_DSO_PLUGIN));
+
+  auto const handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    std::cerr << dlerror() << '\n';
+    return EXIT_FAILURE;
+  }
+  auto const make_there = reinterpret_cast<bench_dso::make_fn *>(
+      dlsym(handle, "bench_dso_make"));
+
+  value const ref = point{0, 1};
+  std::vector<value> here, there;
+  bench_dso::make(here, elements);
+  make_there(there, elements);
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(30) << "ns/element" << std::setw(12) << "here"
+            << "plugin\n";
+  auto const row = [&](char const *name, auto test) {
+    std::cout << std::setw(30) << name << std::setw(12)
+              << ns_per_element(here, repeat, test)
+              << ns_per_element(there, repeat, test) << '\n';
+  };
+  row("same_dynamic_type", [&](value const &x) {
+    return same_dynamic_type(x, ref);
+  });
+  row("  typeid before", [&](value const &x) {
+    return erasure::same_dynamic_type(erasure::concept_ptr(x),
+                                      erasure::concept_ptr(ref));
+  });
+  row("target<point>", [](value const &x) {
+    return erasure::target<point>(x) != nullptr;
+  });
+  row("  dynamic_cast before", [](value const &x) {
+    return dynamic_cast<point_model const *>(erasure::concept_ptr(x)) !=
+           nullptr;
+  });
+  // never closed: the anys made there need its code
+}
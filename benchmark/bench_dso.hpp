@@ -0,0 +1,53 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/** What bench_dso and its plugin share. */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bench_dso {
+
+struct point {
+  int x, y;
+  friend auto operator==(point const &, point const &) -> bool = default;
+};
+struct label {
+  std::string text;
+  friend auto operator==(label const &, label const &) -> bool = default;
+};
+
+using value = erasure::any<erasure::features::regular>;
+
+/** Appends n values to out, alternating point and label. */
+inline void make(std::vector<value> &out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i % 2 == 0) {
+      out.emplace_back(point{static_cast<int>(i), 1});
+    } else {
+      out.emplace_back(label{"label"});
+    }
+  }
+}
+
+using make_fn = void(std::vector<value> &out, std::size_t n);
+
+} // namespace bench_dso
@@ -0,0 +1,24 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** The plugin bench_dso loads: makes anys with its own vtables. */
+
+#include "bench_dso.hpp"
+
+extern "C" __attribute__((visibility("default"))) void
+bench_dso_make(std::vector<bench_dso::value> &out, std::size_t n) {
+  bench_dso::make(out, n);
+}
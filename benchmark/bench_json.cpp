@@ -0,0 +1,158 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * A JSON-like document model on `any`.
+ *
+ * A value is null, a bool, an int64, a double, a string, an array of values
+ * or an object of (key, value) pairs. The records document is an array of
+ * objects of mostly scalar fields; the numbers document is one array of ints
+ * and doubles. For handles with no buffer, with a 16 byte buffer and with a
+ * 16 byte buffer and `pack_scalars`, prints the ns per node to build, copy, compare and destroy
+ * each document.
+ *
+ * Options: --records=N --repeat=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace f = erasure::features;
+
+template <typename Json>
+using array = std::vector<Json>;
+template <typename Json>
+using object = std::vector<std::pair<std::string, Json>>;
+
+template <typename Json>
+auto make_record(std::int64_t i) -> Json {
+  array<Json> tags;
+  for (std::int64_t t = 0; t < 4; ++t) {
+    tags.push_back(Json{i * 4 + t});
+  }
+  object<Json> record;
+  record.emplace_back("id", Json{i});
+  record.emplace_back("score", Json{static_cast<double>(i) / 3});
+  record.emplace_back("active", Json{i % 2 == 0});
+  record.emplace_back("parent", Json{nullptr});
+  record.emplace_back("name", Json{"record " + std::to_string(i)});
+  record.emplace_back("tags", Json{std::move(tags)});
+  record.emplace_back("x", Json{static_cast<double>(i)});
+  record.emplace_back("y", Json{static_cast<double>(-i)});
+  return Json{std::move(record)};
+}
+/** The values in a record: itself, eight fields and four tags. */
+constexpr std::size_t nodes_per_record = 13;
+
+template <typename Json>
+auto make_records(std::size_t records) -> array<Json> {
+  array<Json> document;
+  document.reserve(records);
+  for (std::size_t i = 0; i < records; ++i) {
+    document.push_back(make_record<Json>(static_cast<std::int64_t>(i)));
+  }
+  return document;
+}
+
+template <typename Json>
+auto make_numbers(std::size_t records) -> array<Json> {
+  array<Json> document;
+  document.reserve(records * nodes_per_record);
+  for (std::size_t i = 0; i < records * nodes_per_record; ++i) {
+    auto const n = static_cast<std::int64_t>(i);
+    document.push_back(i % 2 ? Json{n} : Json{static_cast<double>(n)});
+  }
+  return document;
+}
+
+struct result {
+  double build, copy, compare, destroy;
+};
+
+template <typename Json, typename Make>
+auto run(Make make, std::size_t records, std::size_t repeat) -> result {
+  auto const nodes = static_cast<double>(records * nodes_per_record * repeat);
+  result r{};
+  for (std::size_t i = 0; i < repeat; ++i) {
+    auto start = bench_util::now_ns();
+    auto document = make(records);
+    bench_util::clobber_memory();
+    auto stop = bench_util::now_ns();
+    r.build += static_cast<double>(stop - start);
+
+    start = bench_util::now_ns();
+    auto copy = document;
+    bench_util::clobber_memory();
+    stop = bench_util::now_ns();
+    r.copy += static_cast<double>(stop - start);
+
+    start = bench_util::now_ns();
+    auto const equal = copy == document;
+    bench_util::do_not_optimize(equal);
+    stop = bench_util::now_ns();
+    r.compare += static_cast<double>(stop - start);
+
+    start = bench_util::now_ns();
+    copy = array<Json>{};
+    bench_util::clobber_memory();
+    stop = bench_util::now_ns();
+    r.destroy += static_cast<double>(stop - start);
+  }
+  return {r.build / nodes, r.copy / nodes, r.compare / nodes,
+          r.destroy / nodes};
+}
+
+template <typename Json>
+void report(char const *name, std::size_t records, std::size_t repeat) {
+  auto const print = [&](char const *document, result const &r) {
+    std::cout << std::setw(20) << name << std::setw(10) << document
+              << std::setw(8) << sizeof(Json) << std::setw(10) << r.build
+              << std::setw(10) << r.copy << std::setw(10) << r.compare
+              << std::setw(10) << r.destroy << '\n';
+  };
+  print("records", run<Json>(make_records<Json>, records, repeat));
+  print("numbers", run<Json>(make_numbers<Json>, records, repeat));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const records = opts.get("records", std::uint64_t{100000});
+  auto const repeat = opts.get("repeat", std::uint64_t{10});
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(20) << "ns/node" << std::setw(10) << "document"
+            << std::setw(8) << "bytes" << std::setw(10) << "build"
+            << std::setw(10) << "copy" << std::setw(10) << "compare"
+            << std::setw(10) << "destroy" << '\n';
+  report<erasure::any<f::regular>>("heap", records, repeat);
+  report<erasure::any<f::regular, f::buffer_size<16>>>("buffer_size<16>",
+                                                       records, repeat);
+  report<erasure::any<f::regular, f::buffer_size<16>, f::pack_scalars>>(
+      "pack_scalars", records, repeat);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * An expensive pure function, erased, with and without a memoizing cache.
+ *
+ * The function does --work rounds of integer mixing. It is called --calls
+ * times per thread with arguments drawn from --keys keys, where key k comes
+ * up about twice as often as key 2k, so that a few keys are hot. Prints ns
+ * per call and the hit rate for the plain function<> and memoized<> on one
+ * thread, and for sharded_memoized<> on 1 to --threads threads. Both caches
+ * hold 1024 results.
+ *
+ * Options: --calls=N --keys=N --work=N --threads=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/memoized.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace f = erasure::features;
+
+struct mixer {
+  std::uint64_t rounds;
+  auto operator()(std::uint64_t x) const -> std::uint64_t {
+    for (std::uint64_t i = 0; i < rounds; ++i) {
+      x = x * 0x9E3779B97F4A7C15u + (x >> 29);
+    }
+    return x;
+  }
+};
+
+/** Keys with P(k) roughly proportional to 1 / k. */
+auto make_keys(std::size_t n, std::uint64_t keys, std::uint64_t seed)
+    -> std::vector<std::uint64_t> {
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<double> u(
+      0.0, std::log(static_cast<double>(keys) + 1));
+  std::vector<std::uint64_t> xs(n);
+  for (auto &x : xs) {
+    x = static_cast<std::uint64_t>(std::exp(u(rng))) - 1;
+  }
+  return xs;
+}
+
+void print(char const *name, std::size_t threads, double ns, double hit_rate) {
+  std::cout << std::setw(20) << name << std::setw(10) << threads
+            << std::setw(12) << ns << hit_rate << '\n';
+}
+
+template <typename Fn>
+auto ns_per_call(std::vector<std::uint64_t> const &keys, Fn &&fn) -> double {
+  std::uint64_t sum = 0;
+  auto const start = bench_util::now_ns();
+  for (auto const k : keys) {
+    sum += fn(k);
+  }
+  auto const stop = bench_util::now_ns();
+  bench_util::do_not_optimize(sum);
+  return static_cast<double>(stop - start) / static_cast<double>(keys.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const calls = opts.get("calls", std::uint64_t{2000000});
+  auto const key_count = opts.get("keys", std::uint64_t{4096});
+  auto const work = opts.get("work", std::uint64_t{200});
+  auto const max_threads =
+      opts.get("threads", std::uint64_t{std::max(
+                              1u, std::thread::hardware_concurrency())});
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(20) << "function" << std::setw(10) << "threads"
+            << std::setw(12) << "ns/call"
+            << "hit rate\n";
+
+  auto const keys = make_keys(calls, key_count, 1);
+  {
+    erasure::any<f::function<std::uint64_t(std::uint64_t) const>> plain =
+        mixer{work};
+    print("function", 1, ns_per_call(keys, plain), 0);
+  }
+  {
+    erasure::memoized<std::uint64_t(std::uint64_t), 1024> memo = mixer{work};
+    auto const ns = ns_per_call(keys, memo);
+    print("memoized", 1, ns, memo.stats().hit_rate());
+  }
+  for (std::uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    erasure::sharded_memoized<std::uint64_t(std::uint64_t), 16, 64> memo =
+        mixer{work};
+    std::vector<std::vector<std::uint64_t>> thread_keys;
+    for (std::uint64_t t = 0; t < threads; ++t) {
+      thread_keys.push_back(make_keys(calls, key_count, t + 1));
+    }
+    std::vector<double> ns(threads);
+    std::vector<std::thread> workers;
+    for (std::uint64_t t = 0; t < threads; ++t) {
+      workers.emplace_back(
+          [&, t] { ns[t] = ns_per_call(thread_keys[t], memo); });
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+    double total = 0;
+    for (auto const x : ns) {
+      total += x;
+    }
+    print("sharded_memoized", threads, total / static_cast<double>(threads),
+          memo.stats().hit_rate());
+  }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * An operation the any type doesn't have, three ways.
+ *
+ * Sums the "area" of --elements `any<regular>` holding values of 8 types in
+ * random order: with a cascade of `target<T>` tests, with an `open_method`,
+ * and, for reference, with the area as a feature of the any type
+ * (`callable<double() const>`). Prints the ns per element of each.
+ *
+ * Options: --elements=N --repeat=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/regular.hpp"
+#include "erasure/open_method.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+// open_methods need types with external linkage
+namespace bench_open_method {
+/** Shape N has area N times its side; the types differ only by N. */
+template <int N>
+struct shape {
+  double side;
+  auto operator()() const -> double { return N * side; }
+  friend auto operator==(shape const &, shape const &) -> bool = default;
+};
+} // namespace bench_open_method
+
+namespace {
+
+namespace f = erasure::features;
+using bench_open_method::shape;
+
+using shape_numbers = std::make_integer_sequence<int, 8>;
+
+template <typename Any, int... Ns>
+auto make(std::size_t n, std::integer_sequence<int, Ns...>)
+    -> std::vector<Any> {
+  std::mt19937_64 rng{7};
+  std::vector<Any> xs;
+  xs.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const which = static_cast<int>(rng() % sizeof...(Ns));
+    auto const side = static_cast<double>(i % 100);
+    ((which == Ns ? (void)xs.emplace_back(shape<Ns>{side}) : (void)0), ...);
+  }
+  return xs;
+}
+
+/** What we do now: test for every type in turn. */
+template <typename Any, int... Ns>
+auto cascade_area(Any const &x, std::integer_sequence<int, Ns...>) -> double {
+  double area = 0;
+  auto const try_area = [&]<int N>(shape<N> const *s) {
+    if (s) {
+      area = (*s)();
+    }
+    return s != nullptr;
+  };
+  (try_area(erasure::target<shape<Ns>>(x)) || ...);
+  return area;
+}
+
+template <int... Ns>
+void define_area(erasure::open_method<double()> &area,
+                 std::integer_sequence<int, Ns...>) {
+  (area.define<shape<Ns>>([](shape<Ns> const &s) { return s(); }), ...);
+}
+
+template <typename Any, typename Area>
+auto ns_per_element(std::vector<Any> const &xs, std::size_t repeat,
+                    Area area) -> double {
+  double sum = 0;
+  auto const start = bench_util::now_ns();
+  for (std::size_t i = 0; i < repeat; ++i) {
+    for (auto const &x : xs) {
+      sum += area(x);
+    }
+  }
+  auto const stop = bench_util::now_ns();
+  bench_util::do_not_optimize(sum);
+  return static_cast<double>(stop - start) /
+         static_cast<double>(xs.size() * repeat);
+}
+
+void print(char const *name, double ns) {
+  std::cout << std::setw(20) << name << ns << '\n';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const elements = opts.get("elements", std::uint64_t{1000000});
+  auto const repeat = opts.get("repeat", std::uint64_t{10});
+
+  using value = erasure::any<f::regular>;
+  using with_area = erasure::any<f::regular, f::callable<double() const>>;
+
+  erasure::open_method<double()> area;
+  define_area(area, shape_numbers{});
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(20) << "area by" << "ns/element\n";
+  auto const values = make<value>(elements, shape_numbers{});
+  print("target<T> cascade",
+        ns_per_element(values, repeat, [](value const &x) {
+          return cascade_area(x, shape_numbers{});
+        }));
+  print("open_method", ns_per_element(values, repeat, [&](value const &x) {
+          return area(x);
+        }));
+  auto const shapes = make<with_area>(elements, shape_numbers{});
+  print("feature", ns_per_element(shapes, repeat,
+                                  [](with_area const &x) { return x(); }));
+}
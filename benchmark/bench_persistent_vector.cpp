@@ -0,0 +1,158 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Snapshots of a large vector of anys, copied and shared.
+ *
+ * Builds --elements `any<regular>`, int64s with a string that spills to the
+ * heap every 16th, in a std::vector and in a persistent_any_vector (through
+ * a transient). Then takes --versions snapshots of each, with --edits
+ * random elements of each version replaced, and reads every element of the
+ * last one. Prints the ms to build, the us to take a snapshot, the ms to take
+ * one and edit it, and the ns per element read.
+ *
+ * Options: --elements=N --versions=N --edits=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+#include "erasure/persistent_vector.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using value = erasure::any<erasure::features::regular>;
+
+auto make_value(std::uint64_t i) -> value {
+  if (i % 16 == 0) {
+    return std::string(40, static_cast<char>('a' + i % 26));
+  }
+  return static_cast<std::int64_t>(i);
+}
+
+auto ms_since(std::uint64_t start) -> double {
+  return static_cast<double>(bench_util::now_ns() - start) / 1e6;
+}
+
+auto sum(value const &x) -> std::int64_t {
+  auto const i = erasure::target<std::int64_t>(x);
+  return i ? *i : 1;
+}
+
+void print(char const *name, double vector, double persistent) {
+  std::cout << std::setw(24) << name << std::setw(14) << vector << persistent
+            << '\n';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const elements = opts.get("elements", std::uint64_t{10000000});
+  auto const versions = opts.get("versions", std::uint64_t{10});
+  auto const edits = opts.get("edits", std::uint64_t{100});
+
+  std::mt19937_64 rng{3};
+  std::vector<std::uint64_t> edit_at(versions * edits);
+  for (auto &i : edit_at) {
+    i = rng() % elements;
+  }
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(24) << "" << std::setw(14) << "std::vector"
+            << "persistent\n";
+
+  auto start = bench_util::now_ns();
+  std::vector<value> vec;
+  vec.reserve(elements);
+  for (std::uint64_t i = 0; i < elements; ++i) {
+    vec.push_back(make_value(i));
+  }
+  auto const vec_build = ms_since(start);
+
+  start = bench_util::now_ns();
+  erasure::transient_any_vector<value> t;
+  for (std::uint64_t i = 0; i < elements; ++i) {
+    t.push_back(make_value(i));
+  }
+  auto pvec = std::move(t).persistent();
+  auto const pvec_build = ms_since(start);
+  print("build, ms", vec_build, pvec_build);
+
+  auto const per_version = static_cast<double>(versions);
+  {
+    start = bench_util::now_ns();
+    for (std::uint64_t v = 0; v < versions; ++v) {
+      auto const snapshot = vec;
+      bench_util::do_not_optimize(snapshot.data());
+    }
+    auto const vec_ms = ms_since(start) / per_version;
+    start = bench_util::now_ns();
+    for (std::uint64_t v = 0; v < versions; ++v) {
+      auto const snapshot = pvec;
+      bench_util::do_not_optimize(snapshot.size());
+    }
+    print("snapshot, us", 1e3 * vec_ms, 1e3 * ms_since(start) / per_version);
+  }
+
+  // each version keeps the one before as it was
+  start = bench_util::now_ns();
+  auto vec_version = vec;
+  for (std::uint64_t v = 0; v < versions; ++v) {
+    auto next = vec_version;
+    for (std::uint64_t e = 0; e < edits; ++e) {
+      next[edit_at[v * edits + e]] = value(static_cast<std::int64_t>(e));
+    }
+    vec_version = std::move(next);
+  }
+  auto const vec_edit = ms_since(start) / per_version;
+  start = bench_util::now_ns();
+  auto pvec_version = pvec;
+  for (std::uint64_t v = 0; v < versions; ++v) {
+    auto next = pvec_version.transient();
+    for (std::uint64_t e = 0; e < edits; ++e) {
+      next.set(edit_at[v * edits + e], static_cast<std::int64_t>(e));
+    }
+    pvec_version = std::move(next).persistent();
+  }
+  print("snapshot + edits, ms", vec_edit, ms_since(start) / per_version);
+
+  std::int64_t total = 0;
+  start = bench_util::now_ns();
+  for (auto const &x : vec_version) {
+    total += sum(x);
+  }
+  auto const vec_read = static_cast<double>(bench_util::now_ns() - start) /
+                        static_cast<double>(elements);
+  start = bench_util::now_ns();
+  pvec_version.for_each_chunk([&](std::span<value const> chunk) {
+    for (auto const &x : chunk) {
+      total += sum(x);
+    }
+  });
+  auto const pvec_read = static_cast<double>(bench_util::now_ns() - start) /
+                         static_cast<double>(elements);
+  bench_util::do_not_optimize(total);
+  print("read, ns/element", vec_read, pvec_read);
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Traversal of heap-spilled anys with and without prefetching.
+ *
+ * Fills a vector with --elements (default 8M, far beyond the last level
+ * cache) `any<movable, callable<int64()const>>`, whose 40 byte models are on
+ * the heap, once with the models in the order of the vector and once
+ * shuffled. Every call does --work rounds of integer mixing, as a stand-in
+ * for real work; without any, the processor overlaps the misses of the next
+ * elements by itself. Prints the ns per element to call every element in a
+ * plain loop and with for_each_prefetched at a few distances and the tuned
+ * one.
+ *
+ * Options: --elements=N --repeat=N --seed=N --work=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/prefetch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace f = erasure::features;
+
+std::uint64_t work_rounds = 16;
+
+struct payload {
+  std::uint64_t value;
+  std::uint64_t padding[3];
+  auto operator()() const -> std::int64_t {
+    auto h = value;
+    for (std::uint64_t i = 0; i < work_rounds; ++i) {
+      h = h * 0x9E3779B97F4A7C15u + (h >> 29);
+    }
+    return static_cast<std::int64_t>(h);
+  }
+};
+using element =
+    erasure::any<f::movable, f::callable<std::int64_t() const>>;
+
+auto make_sequential(std::size_t n) -> std::vector<element> {
+  std::vector<element> xs;
+  xs.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    xs.emplace_back(payload{i, {}});
+  }
+  return xs;
+}
+
+/** The k-th model allocated ends up at a random place in the vector. */
+auto make_shuffled(std::size_t n, std::uint64_t seed) -> std::vector<element> {
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::shuffle(order.begin(), order.end(), std::mt19937_64{seed});
+  std::vector<element> xs(n);
+  for (std::size_t k = 0; k < n; ++k) {
+    xs[order[k]] = element{payload{k, {}}};
+  }
+  return xs;
+}
+
+template <typename Traverse>
+auto ns_per_element(std::vector<element> const &xs, std::size_t repeat,
+                    Traverse traverse) -> double {
+  std::int64_t sum = 0;
+  auto const start = bench_util::now_ns();
+  for (std::size_t i = 0; i < repeat; ++i) {
+    traverse([&](element const &x) { sum += x(); });
+  }
+  auto const stop = bench_util::now_ns();
+  bench_util::do_not_optimize(sum);
+  return static_cast<double>(stop - start) /
+         static_cast<double>(xs.size() * repeat);
+}
+
+void run(char const *layout, std::vector<element> const &xs,
+         std::size_t repeat) {
+  auto const row = [&](std::string const &name, double ns) {
+    std::cout << std::setw(12) << layout << std::setw(16) << name << ns
+              << '\n';
+  };
+  row("plain loop", ns_per_element(xs, repeat, [&](auto &&fn) {
+        for (auto const &x : xs) {
+          fn(x);
+        }
+      }));
+  for (std::size_t distance : {4, 16, 64}) {
+    row("distance " + std::to_string(distance),
+        ns_per_element(xs, repeat, [&](auto &&fn) {
+          erasure::for_each_prefetched(xs, fn, distance);
+        }));
+  }
+  std::size_t tuned = 0;
+  auto const ns = ns_per_element(xs, repeat, [&](auto &&fn) {
+    tuned = erasure::for_each_prefetched(xs, fn);
+  });
+  row("auto (" + std::to_string(tuned) + ")", ns);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const elements = opts.get("elements", std::uint64_t{8000000});
+  auto const repeat = opts.get("repeat", std::uint64_t{3});
+  auto const seed = opts.get("seed", std::uint64_t{42});
+  work_rounds = opts.get("work", work_rounds);
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(12) << "layout" << std::setw(16) << "traversal"
+            << "ns/element\n";
+  run("sequential", make_sequential(elements), repeat);
+  run("shuffled", make_shuffled(elements, seed), repeat);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Overhead of `profiled<F>` per call.
+ *
+ * Built with ERASURE_ENABLE_PROFILING. Calls a `function<int(int)>` and a
+ * `profiled<function<int(int)>>` holding the same callable in a loop, with
+ * timing off, at the default sample period and timing every call, and prints
+ * ns per call and the difference to the plain call.
+ *
+ * Options: --calls=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/profiled.hpp"
+
+#include <cstdint>
+#include <iostream>
+
+namespace {
+
+namespace f = erasure::features;
+
+struct add {
+  int n;
+  auto operator()(int x) const -> int { return x + n; }
+};
+
+template <typename Any>
+auto ns_per_call(std::uint64_t calls) -> double {
+  Any fn = add{1};
+  int x = 0;
+  // warm up: registers the counters
+  x = fn(x);
+  return bench_util::time_per_iteration(calls, [&] {
+    bench_util::do_not_optimize(x);
+    x = fn(x);
+  });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  namespace profiling = erasure::profiling;
+  bench_util::options const opts(argc, argv);
+  auto const calls = opts.get("calls", std::uint64_t{100000000});
+
+  using plain = erasure::any<f::function<int(int)>>;
+  using profiled = erasure::any<f::profiled<f::function<int(int)>>>;
+
+  auto const default_period = profiling::sample_period();
+  auto const base = ns_per_call<plain>(calls);
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(28) << "function<int(int)>" << base << " ns/call\n";
+
+  auto const run = [&](char const *name, std::uint64_t period) {
+    profiling::set_sample_period(period);
+    auto const t = ns_per_call<profiled>(calls);
+    std::cout << std::setw(28) << name << t << " ns/call (+" << t - base
+              << ")\n";
+  };
+  run("profiled, untimed", 0);
+  run("profiled, default period", default_period);
+  run("profiled, all timed", 1);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Cost of tracing instrumented values.
+ *
+ * Every thread copies an `any<regular>` holding an `instrumented<int>` in a
+ * loop, at 1, 2, 4, ... up to --max-threads threads. Printed are the ns per
+ * copy (a copy construction and a destruction, each one trace record), and
+ * the same loop with a plain int as the floor.
+ *
+ * Every thread keeps the newest --capacity records. With --chrome=FILE, those
+ * of the last run are written to FILE in the Chrome trace event format (open
+ * it in Perfetto or chrome://tracing).
+ *
+ * Options: --max-threads=N --copies=N (per thread) --capacity=N --chrome=FILE
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/instrumented.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using any_regular = erasure::any<erasure::features::regular,
+                                 erasure::features::buffer_size<32>>;
+
+template <typename Value>
+auto ns_per_copy(std::size_t threads, std::uint64_t copies) -> double {
+  std::vector<std::thread> workers;
+  auto const start = bench_util::now_ns();
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([copies] {
+      any_regular x = Value{1};
+      for (std::uint64_t i = 0; i < copies; ++i) {
+        any_regular y = x;
+        bench_util::do_not_optimize(y);
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  auto const ns = bench_util::now_ns() - start;
+  return static_cast<double>(ns) / copies;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const max_threads = opts.get("max-threads", std::uint64_t{8});
+  auto const copies = opts.get("copies", std::uint64_t{1000000});
+  auto const chrome = opts.get("chrome", std::string());
+
+  // keep every record of a run
+  dbg_util::set_trace_capacity(opts.get("capacity", std::uint64_t{1} << 16));
+
+  std::cout << std::setw(8) << "threads" << std::setw(14) << "int ns"
+            << std::setw(14) << "traced ns" << "\n";
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    dbg_util::clear_trace();
+    auto const plain = ns_per_copy<int>(threads, copies);
+    auto const traced = ns_per_copy<dbg_util::instrumented<int>>(threads,
+                                                                 copies);
+    std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2)
+              << std::setw(14) << plain << std::setw(14) << traced << "\n";
+  }
+
+  if (!chrome.empty()) {
+    std::ofstream out(chrome);
+    dbg_util::write_chrome_trace(out);
+    std::cout << "trace written to " << chrome << "\n";
+  }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file bench_util.hpp
+ * A minimal, dependency-free benchmarking harness shared by the benchmarks in
+ * this directory: a clock, optimisation barriers, latency percentiles and
+ * `--name=value` command line parsing.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench_util {
+
+using clock = std::chrono::steady_clock;
+
+inline auto now_ns() -> std::uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             clock::now().time_since_epoch())
+      .count();
+}
+
+/** Make the compiler believe `x` is read, so computing it is not elided. */
+template <typename T>
+[[gnu::always_inline]] inline void do_not_optimize(T const &x) {
+  asm volatile("" : : "r,m"(x) : "memory");
+}
+/** Make the compiler believe all memory was read and written. */
+[[gnu::always_inline]] inline void clobber_memory() {
+  asm volatile("" : : : "memory");
+}
+
+/** Runs `f` `iterations` times and returns the mean time per run in ns. */
+template <typename F>
+auto time_per_iteration(std::size_t iterations, F &&f) -> double {
+  auto const start = now_ns();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    f();
+  }
+  auto const stop = now_ns();
+  return static_cast<double>(stop - start) / static_cast<double>(iterations);
+}
+
+struct latency_summary {
+  std::size_t samples = 0;
+  double mean = 0;
+  std::uint64_t p50 = 0;
+  std::uint64_t p99 = 0;
+  std::uint64_t p999 = 0;
+};
+
+/** Percentiles of a set of samples. Reorders the samples. */
+inline auto summarize(std::vector<std::uint64_t> &samples) -> latency_summary {
+  latency_summary result;
+  result.samples = samples.size();
+  if (samples.empty()) {
+    return result;
+  }
+  std::sort(samples.begin(), samples.end());
+  auto const at = [&](double q) {
+    auto const idx = static_cast<std::size_t>(q * (samples.size() - 1));
+    return samples[idx];
+  };
+  std::uint64_t sum = 0;
+  for (auto s : samples) {
+    sum += s;
+  }
+  result.mean = static_cast<double>(sum) / samples.size();
+  result.p50 = at(0.5);
+  result.p99 = at(0.99);
+  result.p999 = at(0.999);
+  return result;
+}
+
+inline auto operator<<(std::ostream &o, latency_summary const &x)
+    -> std::ostream & {
+  return o << std::setw(7) << x.p50 << std::setw(7) << x.p99 << std::setw(8)
+           << x.p999;
+}
+
+/**
+ * Command line options of the form `--name=value`. Unknown options are
+ * ignored so that wrappers can pass their own.
+ */
+struct options {
+  options(int argc, char **argv) : args(argv + 1, argv + argc) {}
+
+  auto get(std::string const &name, std::string fallback) const
+      -> std::string {
+    auto const prefix = "--" + name + "=";
+    for (auto const &arg : args) {
+      if (arg.compare(0, prefix.size(), prefix) == 0) {
+        return arg.substr(prefix.size());
+      }
+    }
+    return fallback;
+  }
+  auto get(std::string const &name, std::uint64_t fallback) const
+      -> std::uint64_t {
+    auto const value = get(name, std::string());
+    return value.empty() ? fallback : std::strtoull(value.c_str(), nullptr, 10);
+  }
+  auto has(std::string const &flag) const -> bool {
+    return std::find(args.begin(), args.end(), "--" + flag) != args.end();
+  }
+
+  std::vector<std::string> args;
+};
+
+} // namespace bench_util
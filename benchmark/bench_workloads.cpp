@@ -0,0 +1,624 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Three small applications, each written with anys, with a class hierarchy
+ * of virtual functions, and with std::variant.
+ *
+ * - ast: an interpreter for a random arithmetic expression of --nodes nodes
+ *   (constants, variables, mean, product, min, max), evaluated for --evals
+ *   variable bindings and cloned --clones times. The nodes are
+ *   `any<callable<double(env const &) const>, copyable, movable>`.
+ * - events: a dispatch loop that delivers --events random events of 16 types
+ *   to 1-4 handlers each: counters, sums, threshold alerts, and forwarders
+ *   that queue a follow-up event. The handlers are `function<>`s.
+ * - scene: --entities entities of four kinds, updated for --frames frames;
+ *   each frame, the entities that differ from the frame before are written to
+ *   a stream. The entities are `any<regular, ostreamable, callable<...>>`.
+ *
+ * The three versions of an application share everything but how they
+ * dispatch, and must compute the same checksum. Prints the ns per node
+ * evaluated and cloned, per event and per entity and frame.
+ *
+ * Options: --nodes=N --evals=N --clones=N --events=N --entities=N --frames=N
+ */
+
+#include "bench_util.hpp"
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/ostreamable.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+namespace f = erasure::features;
+
+/** What one version of a workload did, and what it computed. */
+struct result {
+  double ns;
+  double checksum;
+};
+
+auto ns_since(std::uint64_t start) -> double {
+  return static_cast<double>(bench_util::now_ns() - start);
+}
+
+namespace ast {
+
+struct env {
+  std::array<double, 8> vars;
+};
+
+// values stay in [-1, 1], so no evaluation ever overflows
+struct constant {
+  double x;
+  auto operator()(env const &) const -> double { return x; }
+};
+struct variable {
+  std::size_t i;
+  auto operator()(env const &e) const -> double { return e.vars[i]; }
+};
+template <typename Node>
+struct mean {
+  Node l, r;
+  auto operator()(env const &e) const -> double { return (l(e) + r(e)) / 2; }
+};
+template <typename Node>
+struct product {
+  Node l, r;
+  auto operator()(env const &e) const -> double { return l(e) * r(e); }
+};
+template <typename Node>
+struct minimum {
+  Node l, r;
+  auto operator()(env const &e) const -> double {
+    return std::min(l(e), r(e));
+  }
+};
+template <typename Node>
+struct maximum {
+  Node l, r;
+  auto operator()(env const &e) const -> double {
+    return std::max(l(e), r(e));
+  }
+};
+
+struct with_any {
+  using node = erasure::any<f::callable<double(env const &) const>,
+                            f::copyable, f::movable, f::buffer_size<16>>;
+  template <typename N>
+  static auto make(N n) -> node {
+    return node(std::move(n));
+  }
+};
+
+struct with_virtual {
+  struct base {
+    virtual ~base() = default;
+    virtual auto eval(env const &e) const -> double = 0;
+    virtual auto clone() const -> std::unique_ptr<base> = 0;
+  };
+  template <typename N>
+  struct impl final : base {
+    N n;
+    explicit impl(N x) : n(std::move(x)) {}
+    auto eval(env const &e) const -> double override { return n(e); }
+    auto clone() const -> std::unique_ptr<base> override {
+      return std::make_unique<impl>(*this);
+    }
+  };
+  class node {
+  public:
+    explicit node(std::unique_ptr<base> p) : p_(std::move(p)) {}
+    node(node const &x) : p_(x.p_->clone()) {}
+    node(node &&) = default;
+    auto operator=(node x) -> node & {
+      p_ = std::move(x.p_);
+      return *this;
+    }
+    auto operator()(env const &e) const -> double { return p_->eval(e); }
+
+  private:
+    std::unique_ptr<base> p_;
+  };
+  template <typename N>
+  static auto make(N n) -> node {
+    return node(std::make_unique<impl<N>>(std::move(n)));
+  }
+};
+
+struct with_variant {
+  struct expr;
+  class node {
+  public:
+    explicit node(std::unique_ptr<expr> p);
+    node(node const &x);
+    node(node &&) noexcept;
+    ~node();
+    auto operator()(env const &e) const -> double;
+
+  private:
+    std::unique_ptr<expr> p_;
+  };
+  using expr_variant =
+      std::variant<constant, variable, mean<node>, product<node>,
+                   minimum<node>, maximum<node>>;
+  struct expr : expr_variant {
+    using expr_variant::expr_variant;
+  };
+  template <typename N>
+  static auto make(N n) -> node {
+    return node(std::make_unique<expr>(std::move(n)));
+  }
+};
+with_variant::node::node(std::unique_ptr<expr> p) : p_(std::move(p)) {}
+with_variant::node::node(node const &x) : p_(std::make_unique<expr>(*x.p_)) {}
+with_variant::node::node(node &&) noexcept = default;
+with_variant::node::~node() = default;
+auto with_variant::node::operator()(env const &e) const -> double {
+  return std::visit([&](auto const &n) { return n(e); }, *p_);
+}
+
+/** A random expression of n nodes; n is odd, as all operators are binary. */
+template <typename Way>
+auto build(std::mt19937_64 &rng, std::size_t n) -> typename Way::node {
+  using node = typename Way::node;
+  std::uniform_real_distribution<double> unit(-1, 1);
+  if (n == 1) {
+    if (rng() % 2) {
+      return Way::make(constant{unit(rng)});
+    }
+    return Way::make(variable{rng() % std::tuple_size_v<decltype(env::vars)>});
+  }
+  auto const left = 2 * (rng() % ((n - 1) / 2)) + 1;
+  auto l = build<Way>(rng, left);
+  auto r = build<Way>(rng, n - 1 - left);
+  switch (rng() % 4) {
+  case 0:
+    return Way::make(mean<node>{std::move(l), std::move(r)});
+  case 1:
+    return Way::make(product<node>{std::move(l), std::move(r)});
+  case 2:
+    return Way::make(minimum<node>{std::move(l), std::move(r)});
+  default:
+    return Way::make(maximum<node>{std::move(l), std::move(r)});
+  }
+}
+
+struct results {
+  result eval, clone;
+};
+
+template <typename Way>
+auto run(std::size_t nodes, std::size_t evals, std::size_t clones)
+    -> results {
+  std::mt19937_64 rng{1};
+  nodes |= 1;
+  auto const program = build<Way>(rng, nodes);
+  std::uniform_real_distribution<double> unit(-1, 1);
+  std::vector<env> envs(evals);
+  for (auto &e : envs) {
+    for (auto &v : e.vars) {
+      v = unit(rng);
+    }
+  }
+
+  double sum = 0;
+  auto start = bench_util::now_ns();
+  for (auto const &e : envs) {
+    sum += program(e);
+  }
+  auto const eval_ns = ns_since(start);
+
+  start = bench_util::now_ns();
+  for (std::size_t c = 0; c < clones; ++c) {
+    auto const copy = program;
+    bench_util::do_not_optimize(copy);
+  }
+  auto const clone_ns = ns_since(start);
+  // the last clone computes the same
+  auto const copy = program;
+  auto const total = static_cast<double>(nodes);
+  return {{eval_ns / (total * static_cast<double>(evals)), sum},
+          {clone_ns / (total * static_cast<double>(clones)),
+           copy(envs.front())}};
+}
+
+} // namespace ast
+
+namespace events {
+
+struct event {
+  std::uint32_t type;
+  std::uint32_t target;
+  double value;
+};
+constexpr std::uint32_t types = 16;
+
+struct state {
+  std::array<std::uint64_t, 64> counts{};
+  double total = 0;
+  std::uint64_t alerts = 0;
+  /** Events not delivered yet, from head on. */
+  std::vector<event> queue;
+  std::size_t head = 0;
+
+  auto checksum() const -> double {
+    double sum = total + static_cast<double>(alerts);
+    for (auto const c : counts) {
+      sum += static_cast<double>(c);
+    }
+    return sum;
+  }
+};
+
+struct count {
+  state *s;
+  void operator()(event const &e) const { ++s->counts[e.target % 64]; }
+};
+struct sum {
+  state *s;
+  double weight;
+  void operator()(event const &e) const { s->total += weight * e.value; }
+};
+struct alert {
+  state *s;
+  double limit;
+  void operator()(event const &e) const {
+    if (e.value > limit) {
+      ++s->alerts;
+    }
+  }
+};
+/** Queues the event, halved, for another type; values die out in time. */
+struct forward {
+  state *s;
+  std::uint32_t to;
+  void operator()(event const &e) const {
+    if (e.value > 0.25) {
+      s->queue.push_back({to, e.target, e.value / 2});
+    }
+  }
+};
+
+struct with_any {
+  using handler = erasure::any<f::function<void(event const &) const>>;
+  template <typename H>
+  static auto make(H h) -> handler {
+    return handler(h);
+  }
+  static void call(handler const &h, event const &e) { h(e); }
+};
+
+struct with_virtual {
+  struct base {
+    virtual ~base() = default;
+    virtual void handle(event const &e) const = 0;
+  };
+  template <typename H>
+  struct impl final : base {
+    H h;
+    explicit impl(H x) : h(x) {}
+    void handle(event const &e) const override { h(e); }
+  };
+  using handler = std::unique_ptr<base>;
+  template <typename H>
+  static auto make(H h) -> handler {
+    return std::make_unique<impl<H>>(h);
+  }
+  static void call(handler const &h, event const &e) { h->handle(e); }
+};
+
+struct with_variant {
+  using handler = std::variant<count, sum, alert, forward>;
+  template <typename H>
+  static auto make(H h) -> handler {
+    return h;
+  }
+  static void call(handler const &h, event const &e) {
+    std::visit([&](auto const &x) { x(e); }, h);
+  }
+};
+
+template <typename Way>
+auto run(std::size_t events) -> result {
+  std::mt19937_64 rng{2};
+  std::uniform_real_distribution<double> unit(0, 1);
+  state s;
+  std::array<std::vector<typename Way::handler>, types> handlers;
+  for (auto &hs : handlers) {
+    for (auto n = 1 + rng() % 4; n > 0; --n) {
+      switch (rng() % 4) {
+      case 0:
+        hs.push_back(Way::make(count{&s}));
+        break;
+      case 1:
+        hs.push_back(Way::make(sum{&s, unit(rng)}));
+        break;
+      case 2:
+        hs.push_back(Way::make(alert{&s, unit(rng)}));
+        break;
+      default:
+        hs.push_back(Way::make(
+            forward{&s, static_cast<std::uint32_t>(rng() % types)}));
+      }
+    }
+  }
+  s.queue.reserve(4 * events);
+  for (std::size_t i = 0; i < events; ++i) {
+    s.queue.push_back({static_cast<std::uint32_t>(rng() % types),
+                       static_cast<std::uint32_t>(rng()), unit(rng)});
+  }
+
+  auto const start = bench_util::now_ns();
+  while (s.head < s.queue.size()) {
+    auto const e = s.queue[s.head++];
+    for (auto const &h : handlers[e.type]) {
+      Way::call(h, e);
+    }
+  }
+  return {ns_since(start) / static_cast<double>(s.head), s.checksum()};
+}
+
+} // namespace events
+
+namespace scene {
+
+struct tick {
+  std::uint64_t frame;
+  double dt;
+};
+
+/** Moves every frame, bouncing off the walls of a 100 x 100 room. */
+struct particle {
+  double x, y, vx, vy;
+  void operator()(tick const &t) {
+    x += vx * t.dt;
+    y += vy * t.dt;
+    if (x < 0 || x > 100) {
+      vx = -vx;
+    }
+    if (y < 0 || y > 100) {
+      vy = -vy;
+    }
+  }
+  friend auto operator==(particle const &, particle const &) -> bool = default;
+  friend auto operator<<(std::ostream &o, particle const &p)
+      -> std::ostream & {
+    return o << "particle " << static_cast<int>(p.x) << ' '
+             << static_cast<int>(p.y);
+  }
+};
+/** Moves every frame, around a centre. */
+struct orbiter {
+  double cx, cy, radius, angle, speed;
+  void operator()(tick const &t) {
+    angle += speed * t.dt;
+    if (angle > 6.283185307179586) {
+      angle -= 6.283185307179586;
+    }
+  }
+  friend auto operator==(orbiter const &, orbiter const &) -> bool = default;
+  friend auto operator<<(std::ostream &o, orbiter const &x) -> std::ostream & {
+    return o << "orbiter " << static_cast<int>(x.angle * 1000);
+  }
+};
+/** Changes once every period frames. */
+struct blinker {
+  std::uint64_t period;
+  bool on;
+  void operator()(tick const &t) { on = (t.frame / period) % 2 == 1; }
+  friend auto operator==(blinker const &, blinker const &) -> bool = default;
+  friend auto operator<<(std::ostream &o, blinker const &b) -> std::ostream & {
+    return o << "blinker " << (b.on ? "on" : "off");
+  }
+};
+/** Never changes. */
+struct prop {
+  std::uint32_t model;
+  void operator()(tick const &) {}
+  friend auto operator==(prop const &, prop const &) -> bool = default;
+  friend auto operator<<(std::ostream &o, prop const &p) -> std::ostream & {
+    return o << "prop " << p.model;
+  }
+};
+
+struct with_any {
+  using entity = erasure::any<f::regular, f::ostreamable,
+                              f::callable<void(tick const &)>,
+                              f::buffer_size<48>>;
+  template <typename E>
+  static auto make(E e) -> entity {
+    return entity(e);
+  }
+  static void update(entity &x, tick const &t) { x(t); }
+  static auto equal(entity const &x, entity const &y) -> bool {
+    return x == y;
+  }
+  static void assign(entity &x, entity const &y) { x = y; }
+  static auto copy(entity const &x) -> entity { return x; }
+  static void print(std::ostream &o, entity const &x) { o << x; }
+};
+
+struct with_virtual {
+  struct base {
+    virtual ~base() = default;
+    virtual void update(tick const &t) = 0;
+    virtual auto equals(base const &x) const -> bool = 0;
+    /** Copies x in place if it is of the same type; false if not. */
+    virtual auto assign(base const &x) -> bool = 0;
+    virtual auto clone() const -> std::unique_ptr<base> = 0;
+    virtual void print(std::ostream &o) const = 0;
+  };
+  template <typename E>
+  struct impl final : base {
+    E e;
+    explicit impl(E x) : e(x) {}
+    void update(tick const &t) override { e(t); }
+    auto equals(base const &x) const -> bool override {
+      return typeid(x) == typeid(impl) &&
+             e == static_cast<impl const &>(x).e;
+    }
+    auto assign(base const &x) -> bool override {
+      if (typeid(x) != typeid(impl)) {
+        return false;
+      }
+      e = static_cast<impl const &>(x).e;
+      return true;
+    }
+    auto clone() const -> std::unique_ptr<base> override {
+      return std::make_unique<impl>(*this);
+    }
+    void print(std::ostream &o) const override { o << e; }
+  };
+  using entity = std::unique_ptr<base>;
+  template <typename E>
+  static auto make(E e) -> entity {
+    return std::make_unique<impl<E>>(e);
+  }
+  static void update(entity &x, tick const &t) { x->update(t); }
+  static auto equal(entity const &x, entity const &y) -> bool {
+    return x->equals(*y);
+  }
+  static void assign(entity &x, entity const &y) {
+    if (!x->assign(*y)) {
+      x = y->clone();
+    }
+  }
+  static auto copy(entity const &x) -> entity { return x->clone(); }
+  static void print(std::ostream &o, entity const &x) { x->print(o); }
+};
+
+struct with_variant {
+  using entity = std::variant<particle, orbiter, blinker, prop>;
+  template <typename E>
+  static auto make(E e) -> entity {
+    return e;
+  }
+  static void update(entity &x, tick const &t) {
+    std::visit([&](auto &e) { e(t); }, x);
+  }
+  static auto equal(entity const &x, entity const &y) -> bool {
+    return x == y;
+  }
+  static void assign(entity &x, entity const &y) { x = y; }
+  static auto copy(entity const &x) -> entity { return x; }
+  static void print(std::ostream &o, entity const &x) {
+    std::visit([&](auto const &e) { o << e; }, x);
+  }
+};
+
+template <typename Way>
+auto run(std::size_t entities, std::size_t frames) -> result {
+  std::mt19937_64 rng{3};
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::vector<typename Way::entity> current, previous;
+  current.reserve(entities);
+  for (std::size_t i = 0; i < entities; ++i) {
+    auto const kind = rng() % 10;
+    if (kind < 3) {
+      current.push_back(Way::make(particle{100 * unit(rng), 100 * unit(rng),
+                                           unit(rng) - 0.5,
+                                           unit(rng) - 0.5}));
+    } else if (kind < 5) {
+      current.push_back(Way::make(orbiter{100 * unit(rng), 100 * unit(rng),
+                                          10 * unit(rng), 0, unit(rng)}));
+    } else if (kind < 8) {
+      current.push_back(Way::make(blinker{2 + rng() % 30, false}));
+    } else {
+      current.push_back(
+          Way::make(prop{static_cast<std::uint32_t>(rng() % 1000)}));
+    }
+  }
+  previous.reserve(entities);
+  for (auto const &x : current) {
+    previous.push_back(Way::copy(x));
+  }
+
+  std::ostringstream out;
+  double written = 0;
+  auto const start = bench_util::now_ns();
+  for (std::uint64_t frame = 1; frame <= frames; ++frame) {
+    out.str({});
+    tick const t{frame, 0.016};
+    for (std::size_t i = 0; i < entities; ++i) {
+      Way::update(current[i], t);
+      if (!Way::equal(current[i], previous[i])) {
+        Way::print(out, current[i]);
+        out << '\n';
+        Way::assign(previous[i], current[i]);
+      }
+    }
+    written += static_cast<double>(out.tellp());
+  }
+  return {ns_since(start) / static_cast<double>(entities * frames), written};
+}
+
+} // namespace scene
+
+void print(char const *name, result const &any, result const &virt,
+           result const &variant) {
+  std::cout << std::setw(20) << name << std::setw(10) << any.ns
+            << std::setw(10) << virt.ns << variant.ns << '\n';
+  if (any.checksum != virt.checksum || any.checksum != variant.checksum) {
+    std::cerr << name << ": the versions computed different results\n";
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bench_util::options const opts(argc, argv);
+  auto const nodes = opts.get("nodes", std::uint64_t{4095});
+  auto const evals = opts.get("evals", std::uint64_t{20000});
+  auto const clones = opts.get("clones", std::uint64_t{200});
+  auto const event_count = opts.get("events", std::uint64_t{2000000});
+  auto const entities = opts.get("entities", std::uint64_t{100000});
+  auto const frames = opts.get("frames", std::uint64_t{50});
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(20) << "ns per" << std::setw(10) << "any"
+            << std::setw(10) << "virtual" << "variant\n";
+
+  auto const a = ast::run<ast::with_any>(nodes, evals, clones);
+  auto const v = ast::run<ast::with_virtual>(nodes, evals, clones);
+  auto const w = ast::run<ast::with_variant>(nodes, evals, clones);
+  print("ast node evaluated", a.eval, v.eval, w.eval);
+  print("ast node cloned", a.clone, v.clone, w.clone);
+
+  print("event", events::run<events::with_any>(event_count),
+        events::run<events::with_virtual>(event_count),
+        events::run<events::with_variant>(event_count));
+
+  print("entity and frame", scene::run<scene::with_any>(entities, frames),
+        scene::run<scene::with_virtual>(entities, frames),
+        scene::run<scene::with_variant>(entities, frames));
+}
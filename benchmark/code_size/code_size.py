@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+# Copyright 2015, 2016 Gašper Ažman
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Code-size report per feature and per instantiation.
+
+Compiles one translation unit per (feature set x value type), each of which
+instantiates an any with that value type and exercises every feature, plus
+one unit that only includes the headers. The .text, .rodata and .data.rel.ro
+bytes of every object (summed over their per-symbol COMDAT sections) minus
+those of the header-only unit are what the instantiation costs.
+
+The report has three parts:
+  per instantiation  bytes per (feature set x value type).
+  per feature        bytes that adding one feature to `copyable` costs,
+                     per value type.
+  symbols            with --symbols, the `nm --size-sort` listing of the
+                     largest symbols of every unit.
+
+--check only builds the `copyable` and `copyable + trivial` units, where
+`trivial` is a feature with a single slot returning a constant, and exits 1
+if adding it grows the code by more than --max-trivial-bytes for any value
+type. ctest runs it that way.
+"""
+from __future__ import print_function, with_statement, division
+import argparse
+import collections
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SECTIONS = ['.text', '.rodata', '.data.rel.ro']
+
+PRELUDE = r'''
+#include "erasure/erasure.hpp"
+#include "erasure/feature/equality_comparable.hpp"
+#include "erasure/feature/less_than_comparable.hpp"
+#include "erasure/feature/ostreamable.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <array>
+#include <iostream>
+#include <string>
+
+namespace ef = erasure::features;
+
+/* The smallest useful feature: one slot, returning a constant. */
+struct trivial : erasure::feature_support::feature {
+  template <typename C>
+  struct vtbl : C {
+    using C::erase;
+    virtual auto erase(erasure::tag_t<trivial>) const -> int = 0;
+  };
+  template <typename M>
+  struct model : M {
+    using M::erase;
+    auto erase(erasure::tag_t<trivial>) const -> int final { return 0; }
+  };
+  template <typename I>
+  struct interface : I {
+    friend auto trivial_call(erasure::ifc<I> const &x) -> int {
+      return erasure::call<trivial>(x);
+    }
+  };
+};
+
+struct big {
+  std::array<long, 8> words{};
+  friend auto operator==(big const &x, big const &y) -> bool {
+    return x.words == y.words;
+  }
+  friend auto operator<(big const &x, big const &y) -> bool {
+    return x.words < y.words;
+  }
+  friend auto operator<<(std::ostream &o, big const &x) -> std::ostream & {
+    return o << x.words[0];
+  }
+};
+'''
+
+# name -> (features, statements using `a` and `b` of the any type)
+FEATURES = collections.OrderedDict([
+    ('equality_comparable', ('ef::equality_comparable', 'r += a == b;')),
+    ('less_than_comparable', ('ef::less_than_comparable', 'r += a < b;')),
+    ('ostreamable', ('ef::ostreamable', 'o << a;')),
+    ('swappable', ('ef::swappable', 'swap(a, b);')),
+    ('trivial', ('trivial', 'r += trivial_call(a);')),
+])
+BASE_SET = 'copyable'
+# name -> (tags, features exercised)
+FEATURE_SETS = collections.OrderedDict([
+    ('movable', (['ef::movable'], [])),
+    ('copyable', (['ef::movable', 'ef::copyable'], [])),
+    ('regular', (['ef::regular'], ['equality_comparable'])),
+    ('regular+ostreamable', (['ef::regular', 'ef::ostreamable'],
+                             ['equality_comparable', 'ostreamable'])),
+    ('regular+ordered+ostreamable',
+     (['ef::regular', 'ef::less_than_comparable', 'ef::ostreamable'],
+      ['equality_comparable', 'less_than_comparable', 'ostreamable'])),
+])
+VALUE_TYPES = ['int', 'double', 'std::string', 'big']
+
+
+def unit(tags, uses, value_type):
+    """A translation unit instantiating any<tags...> with value_type."""
+    copying = 'ef::copyable' in tags or 'ef::regular' in tags
+    body = ['  any_type a = v;', '  any_type b = %s;' %
+            ('a' if copying else 'v'), '  int r = 0;']
+    body += ['  ' + use for use in uses]
+    body.append('  return r + static_cast<int>(erasure::target<%s>(b) != '
+                'nullptr);' % value_type)
+    return PRELUDE + r'''
+using any_type = erasure::any<%s>;
+
+auto use(%s const &v, std::ostream &o) -> int {
+%s
+}
+''' % (', '.join(tags), value_type, '\n'.join(body))
+
+
+def feature_set_unit(name, value_type):
+    tags, features = FEATURE_SETS[name]
+    return unit(tags, [FEATURES[f][1] for f in features], value_type)
+
+
+def added_feature_unit(feature, value_type):
+    tags, features = FEATURE_SETS[BASE_SET]
+    return unit(tags + [FEATURES[feature][0]],
+                [FEATURES[f][1] for f in features] + [FEATURES[feature][1]],
+                value_type)
+
+
+def section_sizes(obj):
+    """Bytes per reported section, summed over per-symbol sections."""
+    out = subprocess.check_output(['size', '-A', obj],
+                                  universal_newlines=True)
+    sizes = dict((s, 0) for s in SECTIONS)
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) < 2 or not fields[1].isdigit():
+            continue
+        for section in sorted(SECTIONS, key=len, reverse=True):
+            if fields[0] == section or fields[0].startswith(section + '.'):
+                sizes[section] += int(fields[1])
+                break
+    return sizes
+
+
+def largest_symbols(obj, count):
+    out = subprocess.check_output(
+        ['nm', '--size-sort', '--reverse-sort', '-C', '-S', obj],
+        universal_newlines=True)
+    return out.splitlines()[:count]
+
+
+class Builder(object):
+
+    def __init__(self, args):
+        self.args = args
+        self.flags = ['-std=c++20', '-I', args.include] + args.flags.split()
+        if not os.path.isdir(args.work_dir):
+            os.makedirs(args.work_dir)
+        self.empty = self.build('headers_only', PRELUDE)
+
+    def build(self, name, text):
+        """Compiles a unit; returns (section sizes, object path)."""
+        source = os.path.join(self.args.work_dir, name + '.cpp')
+        obj = os.path.join(self.args.work_dir, name + '.o')
+        with open(source, 'w') as f:
+            f.write(text)
+        subprocess.check_call([self.args.compiler] + self.flags +
+                              ['-c', source, '-o', obj])
+        return section_sizes(obj), obj
+
+    def cost(self, name, text):
+        """Section sizes of a unit over the header-only unit."""
+        sizes, obj = self.build(name, text)
+        if self.args.symbols:
+            print('\n# %s' % name)
+            for line in largest_symbols(obj, self.args.symbols):
+                print(line)
+        return dict((s, sizes[s] - self.empty[0][s]) for s in SECTIONS)
+
+
+def identifier(text):
+    return ''.join(c if c.isalnum() else '_' for c in text)
+
+
+def row(label, sizes):
+    total = sum(sizes[s] for s in SECTIONS)
+    return '%-48s %8d %8d %13d %8d' % (label, sizes['.text'], sizes['.rodata'],
+                                      sizes['.data.rel.ro'], total)
+
+
+def header(title):
+    return '\n%-48s %8s %8s %13s %8s' % (title, '.text', '.rodata',
+                                         '.data.rel.ro', 'total')
+
+
+def delta(after, before):
+    return dict((s, after[s] - before[s]) for s in SECTIONS)
+
+
+def report(builder):
+    base = {}
+    print(header('per instantiation (feature set x value type)'))
+    for name in FEATURE_SETS:
+        for value_type in VALUE_TYPES:
+            sizes = builder.cost(identifier(name + '_' + value_type),
+                                 feature_set_unit(name, value_type))
+            if name == BASE_SET:
+                base[value_type] = sizes
+            print(row('%s x %s' % (name, value_type), sizes))
+    print(header('per feature (added to %s)' % BASE_SET))
+    for feature in FEATURES:
+        for value_type in VALUE_TYPES:
+            sizes = builder.cost(
+                identifier(BASE_SET + '_' + feature + '_' + value_type),
+                added_feature_unit(feature, value_type))
+            print(row('+%s x %s' % (feature, value_type),
+                      delta(sizes, base[value_type])))
+    return 0
+
+
+def check(builder, max_bytes):
+    failed = False
+    print(header('+trivial over %s' % BASE_SET))
+    for value_type in VALUE_TYPES:
+        base = builder.cost(identifier(BASE_SET + '_' + value_type),
+                            feature_set_unit(BASE_SET, value_type))
+        grown = builder.cost(
+            identifier(BASE_SET + '_trivial_' + value_type),
+            added_feature_unit('trivial', value_type))
+        growth = delta(grown, base)
+        print(row(value_type, growth))
+        if sum(growth.values()) > max_bytes:
+            failed = True
+    if failed:
+        print('\nadding a trivial feature costs more than %d bytes' %
+              max_bytes)
+        return 1
+    return 0
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--compiler', default=os.environ.get('CXX', 'c++'))
+    parser.add_argument('--include', default=os.path.dirname(
+        os.path.dirname(HERE)), help='the liberasure source directory.')
+    parser.add_argument('--flags', default='-O2',
+                        help='extra compiler flags, space separated.')
+    parser.add_argument('--work-dir', default='code_size_work')
+    parser.add_argument('--symbols', type=int, default=0, metavar='N',
+                        help='list the N largest symbols of every unit.')
+    parser.add_argument('--check', action='store_true',
+                        help='only check the cost of a trivial feature.')
+    parser.add_argument('--max-trivial-bytes', type=int, default=1280)
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    builder = Builder(args)
+    if args.check:
+        return check(builder, args.max_trivial_bytes)
+    return report(builder)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
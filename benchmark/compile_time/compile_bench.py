@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+# Copyright 2015, 2016 Gašper Ažman
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Compile-time benchmark for feature-set scaling.
+
+Generates translation units that stress the template machinery in erasure.hpp
+and meta.hpp, compiles each one and records wall time, peak memory of the
+compiler and the size of the object file.
+
+Two sweeps are run:
+  features        one any with 1..64 synthetic features, all of them called.
+  instantiations  1..500 distinct any types with four features each.
+
+With clang, -ftime-trace output is kept next to every object file in the work
+directory.
+
+Results are compared against a tracked baseline (baseline.json next to this
+script); --update rewrites it. A metric that grows by more than --tolerance
+over its baseline is reported as a regression and makes the script exit 1.
+"""
+from __future__ import print_function, with_statement, division
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_BASELINE = os.path.join(HERE, 'baseline.json')
+
+FEATURE_SWEEP = [1, 2, 4, 8, 16, 32, 64]
+INSTANTIATION_SWEEP = [1, 10, 50, 100, 250, 500]
+# the metrics compared against the baseline
+METRICS = ['seconds', 'peak_rss_kb', 'object_bytes']
+
+PRELUDE = r'''
+#include "erasure/erasure.hpp"
+
+namespace ef = erasure::features;
+
+/* A synthetic feature with one vtable slot and a hidden-friend interface. */
+template <int N>
+struct op : erasure::feature_support::feature {
+  template <typename C>
+  struct vtbl : C {
+    using C::erase;
+    virtual auto erase(erasure::tag_t<op>, int) const -> int = 0;
+  };
+  template <typename M>
+  struct model : M {
+    using M::erase;
+    auto erase(erasure::tag_t<op>, int x) const -> int final {
+      return erasure::value(*this).template apply<N>(x);
+    }
+  };
+  template <typename I>
+  struct interface : I {
+    friend auto apply(erasure::tag_t<op>, erasure::ifc<I> const &self, int x)
+        -> int {
+      return erasure::call<op>(self, x);
+    }
+  };
+};
+
+/* An empty feature, only used to make otherwise equal anys distinct. */
+template <int N>
+struct instance : erasure::feature_support::feature {
+  template <typename C>
+  using vtbl = C;
+  template <typename M>
+  using model = M;
+  template <typename I>
+  using interface = I;
+};
+
+struct value {
+  template <int N>
+  auto apply(int x) const -> int { return x + N; }
+};
+'''
+
+
+def feature_tu(features):
+    ops = ', '.join('op<%d>' % i for i in range(features))
+    calls = ' + '.join('apply(erasure::tag<op<%d>>, b, x)' % i
+                       for i in range(features))
+    return PRELUDE + r'''
+using any_type = erasure::any<ef::copyable, ef::movable, %s>;
+
+auto run(int x) -> int {
+  any_type a = value{};
+  any_type b = a;
+  return %s;
+}
+''' % (ops, calls)
+
+
+def instantiation_tu(instantiations):
+    body = []
+    for i in range(instantiations):
+        body.append(r'''
+using any_%(i)d = erasure::any<ef::copyable, ef::movable, op<0>, op<1>,
+                              instance<%(i)d>>;
+auto run_%(i)d(int x) -> int {
+  any_%(i)d a = value{};
+  any_%(i)d b = a;
+  return apply(erasure::tag<op<0>>, b, x) + apply(erasure::tag<op<1>>, b, x);
+}
+''' % {'i': i})
+    return PRELUDE + ''.join(body)
+
+
+def cases(quick):
+    features = FEATURE_SWEEP[:4] if quick else FEATURE_SWEEP
+    instantiations = INSTANTIATION_SWEEP[:3] if quick else INSTANTIATION_SWEEP
+    for n in features:
+        yield 'features_%d' % n, n, 1, feature_tu(n)
+    for n in instantiations:
+        yield 'instantiations_%d' % n, 4, n, instantiation_tu(n)
+
+
+def is_clang(compiler):
+    out = subprocess.check_output([compiler, '--version'],
+                                  universal_newlines=True)
+    return 'clang' in out
+
+
+def compiler_version(compiler):
+    return subprocess.check_output([compiler, '--version'],
+                                   universal_newlines=True).splitlines()[0]
+
+
+def compile_once(compiler, flags, source, obj):
+    """Returns (wall seconds, peak rss in KiB) of one compiler invocation."""
+    cmd = [compiler] + flags + ['-c', source, '-o', obj]
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd)
+    _, status, usage = os.wait4(proc.pid, 0)
+    seconds = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        raise RuntimeError('compilation failed: ' + ' '.join(cmd))
+    return seconds, usage.ru_maxrss
+
+
+def measure(args):
+    flags = ['-std=c++20', '-I', args.include] + args.flags.split()
+    if is_clang(args.compiler):
+        flags.append('-ftime-trace')
+    if not os.path.isdir(args.work_dir):
+        os.makedirs(args.work_dir)
+    results = []
+    for name, features, instantiations, text in cases(args.quick):
+        source = os.path.join(args.work_dir, name + '.cpp')
+        obj = os.path.join(args.work_dir, name + '.o')
+        with open(source, 'w') as f:
+            f.write(text)
+        runs = [compile_once(args.compiler, flags, source, obj)
+                for _ in range(args.repeat)]
+        result = {
+            'name': name,
+            'features': features,
+            'instantiations': instantiations,
+            'seconds': round(min(r[0] for r in runs), 3),
+            'peak_rss_kb': min(r[1] for r in runs),
+            'object_bytes': os.path.getsize(obj),
+        }
+        print('%-20s %8.3f s %8d KiB %9d B' %
+              (name, result['seconds'], result['peak_rss_kb'],
+               result['object_bytes']))
+        sys.stdout.flush()
+        results.append(result)
+    return {
+        'compiler': compiler_version(args.compiler),
+        'flags': ' '.join(['-std=c++20'] + args.flags.split()),
+        'results': results,
+    }
+
+
+def compare(current, baseline, tolerance):
+    """Prints the change against the baseline; returns the regressions."""
+    if current['compiler'] != baseline['compiler']:
+        print('note: baseline was recorded with "%s"' % baseline['compiler'])
+    old = dict((r['name'], r) for r in baseline['results'])
+    regressions = []
+    print('\n%-20s %-13s %12s %12s %8s' %
+          ('case', 'metric', 'baseline', 'current', 'change'))
+    for result in current['results']:
+        if result['name'] not in old:
+            continue
+        for metric in METRICS:
+            before = old[result['name']][metric]
+            after = result[metric]
+            change = (after - before) / before if before else 0.0
+            flag = ''
+            if change > tolerance:
+                flag = '  REGRESSION'
+                regressions.append((result['name'], metric))
+            print('%-20s %-13s %12s %12s %+7.1f%%%s' %
+                  (result['name'], metric, before, after, 100 * change, flag))
+    return regressions
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--compiler', default=os.environ.get('CXX', 'c++'))
+    parser.add_argument('--include', default=os.path.dirname(
+        os.path.dirname(HERE)), help='the liberasure source directory.')
+    parser.add_argument('--flags', default='-O2',
+                        help='extra compiler flags, space separated.')
+    parser.add_argument('--work-dir', default='compile_time_work')
+    parser.add_argument('--baseline', default=DEFAULT_BASELINE)
+    parser.add_argument('--repeat', type=int, default=1,
+                        help='compile every case this many times, keep the '
+                        'fastest.')
+    parser.add_argument('--tolerance', type=float, default=0.25,
+                        help='allowed relative growth of any metric.')
+    parser.add_argument('--quick', action='store_true',
+                        help='only run the small cases.')
+    parser.add_argument('--update', action='store_true',
+                        help='write the results as the new baseline.')
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    current = measure(args)
+    if args.update:
+        with open(args.baseline, 'w') as f:
+            json.dump(current, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('baseline written to ' + args.baseline)
+        return 0
+    if not os.path.exists(args.baseline):
+        print('no baseline at %s, run with --update' % args.baseline)
+        return 0
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    regressions = compare(current, baseline, args.tolerance)
+    if regressions:
+        print('\n%d metric(s) regressed by more than %d%%' %
+              (len(regressions), 100 * args.tolerance))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
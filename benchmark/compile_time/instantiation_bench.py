@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+# Copyright 2015, 2016 Gašper Ažman
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Compile-time benchmark for explicitly instantiated any types.
+
+Generates a synthetic project of --tus translation units that all use the same
+any type with three value types, and builds it twice:
+  implicit  every translation unit instantiates everything it uses.
+  extern    a shared header declares the any type and its models with
+            ERASURE_EXTERN_ANY / ERASURE_EXTERN_MODEL, and one extra
+            translation unit defines them with the ERASURE_INSTANTIATE_ macros.
+
+For each build it reports the summed compile time, the sum of object file
+sizes, the link time and the size of the linked program, and checks that the
+program runs.
+"""
+from __future__ import print_function, with_statement, division
+import argparse
+import os
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+COMMON = r'''
+#pragma once
+#include "erasure/feature/less_than_comparable.hpp"
+#include "erasure/feature/ostreamable.hpp"
+#include "erasure/feature/regular.hpp"
+#include "erasure/instantiation.hpp"
+
+#include <string>
+#include <vector>
+
+namespace ef = erasure::features;
+
+struct point {
+  int x, y;
+  friend auto operator==(point const &a, point const &b) -> bool {
+    return a.x == b.x && a.y == b.y;
+  }
+  friend auto operator<(point const &a, point const &b) -> bool {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  }
+  template <typename Os>
+  friend auto operator<<(Os &os, point const &p) -> Os & {
+    return os << p.x << ',' << p.y;
+  }
+};
+
+using heavy = erasure::any<ef::regular, ef::less_than_comparable,
+                           ef::ostreamable>;
+'''
+
+EXTERN = r'''
+ERASURE_EXTERN_ANY(heavy);
+ERASURE_EXTERN_MODEL(heavy, int);
+ERASURE_EXTERN_MODEL(heavy, std::string);
+ERASURE_EXTERN_MODEL(heavy, point);
+'''
+
+INSTANTIATE = r'''
+#include "heavy.hpp"
+
+ERASURE_INSTANTIATE_ANY(heavy);
+ERASURE_INSTANTIATE_MODEL(heavy, int);
+ERASURE_INSTANTIATE_MODEL(heavy, std::string);
+ERASURE_INSTANTIATE_MODEL(heavy, point);
+'''
+
+USER = r'''
+#include "heavy.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+auto use_%(i)d(int n) -> std::string {
+  std::vector<heavy> xs;
+  xs.push_back(n);
+  xs.push_back(std::to_string(n));
+  xs.push_back(point{n, %(i)d});
+  std::vector<heavy> ys = xs;
+  std::sort(ys.begin(), ys.end());
+  std::ostringstream out;
+  for (auto const &y : ys) {
+    out << y << (y == xs.front());
+  }
+  return out.str();
+}
+'''
+
+MAIN = r'''
+#include <cstdio>
+#include <string>
+
+%(declarations)s
+int main() {
+  std::size_t total = 0;
+%(calls)s
+  std::printf("%%zu\n", total);
+  return total == 0;
+}
+'''
+
+
+def write(path, text):
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+def generate(directory, tus, extern):
+    """Writes the project; returns the translation units to compile."""
+    if not os.path.isdir(directory):
+        os.makedirs(directory)
+    write(os.path.join(directory, 'heavy.hpp'),
+          COMMON + (EXTERN if extern else ''))
+    sources = []
+    for i in range(tus):
+        source = os.path.join(directory, 'use_%d.cpp' % i)
+        write(source, USER % {'i': i})
+        sources.append(source)
+    main = os.path.join(directory, 'main.cpp')
+    write(main, MAIN % {
+        'declarations': ''.join('auto use_%d(int) -> std::string;\n' % i
+                                for i in range(tus)),
+        'calls': ''.join('  total += use_%d(%d).size();\n' % (i, i)
+                         for i in range(tus)),
+    })
+    sources.append(main)
+    if extern:
+        instantiations = os.path.join(directory, 'instantiations.cpp')
+        write(instantiations, INSTANTIATE)
+        sources.append(instantiations)
+    return sources
+
+
+def compile_one(compiler, flags, source):
+    obj = os.path.splitext(source)[0] + '.o'
+    start = time.perf_counter()
+    subprocess.check_call([compiler] + flags + ['-c', source, '-o', obj])
+    return time.perf_counter() - start, obj
+
+
+def build(args, name, extern):
+    directory = os.path.join(args.work_dir, name)
+    sources = generate(directory, args.tus, extern)
+    flags = ['-std=c++20', '-I', args.include, '-I', directory] + \
+        args.flags.split()
+    start = time.perf_counter()
+    with ThreadPoolExecutor(args.jobs) as pool:
+        compiled = list(pool.map(
+            lambda s: compile_one(args.compiler, flags, s), sources))
+    wall = time.perf_counter() - start
+    objects = [obj for _, obj in compiled]
+    program = os.path.join(directory, 'program')
+    start = time.perf_counter()
+    subprocess.check_call([args.compiler] + objects + ['-o', program])
+    link = time.perf_counter() - start
+    subprocess.check_call([program], stdout=subprocess.DEVNULL)
+    return {
+        'name': name,
+        'cpu_seconds': sum(seconds for seconds, _ in compiled),
+        'wall_seconds': wall,
+        'object_bytes': sum(os.path.getsize(obj) for obj in objects),
+        'link_seconds': link,
+        'program_bytes': os.path.getsize(program),
+    }
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--compiler', default=os.environ.get('CXX', 'c++'))
+    parser.add_argument('--include', default=os.path.dirname(os.path.dirname(
+        os.path.dirname(os.path.abspath(__file__)))),
+        help='the liberasure source directory.')
+    parser.add_argument('--flags', default='-O2',
+                        help='extra compiler flags, space separated.')
+    parser.add_argument('--work-dir', default='instantiation_work')
+    parser.add_argument('--tus', type=int, default=200,
+                        help='translation units that use the any type.')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(),
+                        help='compile this many translation units at once.')
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    results = [build(args, 'implicit', False), build(args, 'extern', True)]
+    print('%-9s %12s %12s %14s %10s %14s' %
+          ('build', 'compile cpu', 'compile wall', 'object bytes', 'link',
+           'program bytes'))
+    for r in results:
+        print('%-9s %10.2f s %10.2f s %14d %8.2f s %14d' %
+              (r['name'], r['cpu_seconds'], r['wall_seconds'],
+               r['object_bytes'], r['link_seconds'], r['program_bytes']))
+    implicit, extern = results
+    print('\nextern saves %.1f%% compile time and %.1f%% object bytes' %
+          (100 * (1 - extern['cpu_seconds'] / implicit['cpu_seconds']),
+           100 * (1 - extern['object_bytes'] / implicit['object_bytes'])))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
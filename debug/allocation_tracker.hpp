@@ -0,0 +1,208 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file allocation_tracker.hpp
+ * Counts what any operations cost: heap allocations of models, inline
+ * placements, virtual dispatches and (optionally) global operator new calls.
+ *
+ * Requires ERASURE_HOOKS to be defined for the whole program (see
+ * erasure/hooks.hpp). Counters are per thread, so an assertion only sees what
+ * its own thread did.
+ *
+ * Usage:
+ *
+ *     ASSERT_ALLOCATIONS(1, y = x);   // copying x spills exactly one model
+ *     ASSERT_DISPATCHES(1, f(1));     // calling f is one virtual call
+ *     ASSERT_OPERATIONS(2, y = x);    // see instrumented.hpp
+ *
+ * To also count global operator new/delete, put DBG_UTIL_COUNT_OPERATOR_NEW()
+ * into exactly one translation unit of the test.
+ */
+
+#ifndef ERASURE_HOOKS
+#error "allocation_tracker.hpp needs ERASURE_HOOKS defined for the program."
+#endif
+
+#include "erasure/hooks.hpp"
+
+#include "instrumented.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+namespace dbg_util {
+
+struct allocation_counts {
+  /** Models that did not fit their small buffer. */
+  std::uint64_t heap_allocations = 0;
+  std::uint64_t heap_deallocations = 0;
+  /** Models placed into their small buffer. */
+  std::uint64_t inline_placements = 0;
+  /** Calls through a model's vtable, including destruction. */
+  std::uint64_t dispatches = 0;
+  /** Only counted with DBG_UTIL_COUNT_OPERATOR_NEW(). */
+  std::uint64_t operator_news = 0;
+  std::uint64_t operator_deletes = 0;
+
+  friend auto operator-(allocation_counts const &x, allocation_counts const &y)
+      -> allocation_counts {
+    return {x.heap_allocations - y.heap_allocations,
+            x.heap_deallocations - y.heap_deallocations,
+            x.inline_placements - y.inline_placements,
+            x.dispatches - y.dispatches, x.operator_news - y.operator_news,
+            x.operator_deletes - y.operator_deletes};
+  }
+  friend auto operator<<(std::ostream &o, allocation_counts const &x)
+      -> std::ostream & {
+    return o << "{heap_allocations: " << x.heap_allocations
+             << ", heap_deallocations: " << x.heap_deallocations
+             << ", inline_placements: " << x.inline_placements
+             << ", dispatches: " << x.dispatches
+             << ", operator_news: " << x.operator_news
+             << ", operator_deletes: " << x.operator_deletes << "}";
+  }
+};
+
+template <typename>
+thread_local allocation_counts thread_counts_ = {};
+/** The running totals of this thread. */
+inline auto thread_counts() -> allocation_counts & {
+  return thread_counts_<void>;
+}
+
+struct allocation_tracker final : erasure::hooks::observer {
+  void placed(erasure::hooks::placement const &p) override {
+    if (p.on_heap) {
+      ++thread_counts().heap_allocations;
+    } else {
+      ++thread_counts().inline_placements;
+    }
+  }
+  void deallocated(void const *) override {
+    ++thread_counts().heap_deallocations;
+  }
+  void dispatched(std::type_info const &) override {
+    ++thread_counts().dispatches;
+  }
+};
+
+/** Registers the tracker on first use; idempotent. */
+inline void install_allocation_tracker() {
+  static allocation_tracker tracker;
+  static bool const installed =
+      (erasure::hooks::add_observer(tracker), true);
+  (void)installed;
+}
+
+/** What this thread did between construction and a call to counts(). */
+struct scoped_counts {
+  scoped_counts() : start((install_allocation_tracker(), thread_counts())) {}
+  auto counts() const -> allocation_counts { return thread_counts() - start; }
+
+private:
+  allocation_counts start;
+};
+
+template <typename F>
+void assert_counts_(char const *file, int line, char const *what,
+                    std::uint64_t allocation_counts::*field, char const *expr,
+                    std::uint64_t expected, F &&f) {
+  scoped_counts counts;
+  f();
+  auto const actual = counts.counts();
+  if (actual.*field != expected) {
+    std::cerr << "Assertion at " << file << ":" << line << " failed.\n"
+              << "Expected " << expected << " " << what << " in `" << expr
+              << "`, got " << actual.*field << ".\n"
+              << "All counts: " << actual << "\n";
+    exit(1);
+  }
+}
+
+template <typename F>
+void assert_operations_(char const *file, int line, char const *expr,
+                        std::uint64_t expected, F &&f) {
+  auto const before = trace().size();
+  f();
+  auto const after = trace();
+  if (after.size() - before != expected) {
+    std::cerr << "Assertion at " << file << ":" << line << " failed.\n"
+              << "Expected " << expected << " operations in `" << expr
+              << "`, got " << after.size() - before << ":\n";
+    print_trace(std::cerr, trace_type(after.begin() + before, after.end()));
+    exit(1);
+  }
+}
+
+#define DBG_UTIL_ASSERT_COUNT_(field, what, n, ...)                            \
+  ::dbg_util::assert_counts_(__FILE__, __LINE__, what,                         \
+                             &::dbg_util::allocation_counts::field,            \
+                             #__VA_ARGS__, (n), [&] { __VA_ARGS__; })
+
+/** Asserts that the expression spills exactly n models to the heap. */
+#define ASSERT_ALLOCATIONS(n, ...)                                             \
+  DBG_UTIL_ASSERT_COUNT_(heap_allocations, "heap allocations", n, __VA_ARGS__)
+/** Asserts that the expression frees exactly n heap-placed models. */
+#define ASSERT_DEALLOCATIONS(n, ...)                                           \
+  DBG_UTIL_ASSERT_COUNT_(heap_deallocations, "heap deallocations", n,          \
+                         __VA_ARGS__)
+/** Asserts that the expression makes exactly n calls through a vtable. */
+#define ASSERT_DISPATCHES(n, ...)                                              \
+  DBG_UTIL_ASSERT_COUNT_(dispatches, "dispatches", n, __VA_ARGS__)
+/** Asserts that the expression calls global operator new exactly n times. */
+#define ASSERT_OPERATOR_NEWS(n, ...)                                           \
+  DBG_UTIL_ASSERT_COUNT_(operator_news, "operator new calls", n, __VA_ARGS__)
+/**
+ * Asserts that the expression does exactly n operations on instrumented
+ * values, i.e. appends n entries to the trace.
+ */
+#define ASSERT_OPERATIONS(n, ...)                                              \
+  ::dbg_util::assert_operations_(__FILE__, __LINE__, #__VA_ARGS__, (n),        \
+                                 [&] { __VA_ARGS__; })
+
+/**
+ * Replaces global operator new and delete with counting versions. The sized
+ * and array deletes are replaced too and forward to the unsized one; the
+ * array and nothrow news forward to these by default.
+ */
+#define DBG_UTIL_COUNT_OPERATOR_NEW()                                          \
+  auto operator new(std::size_t size)->void * {                                \
+    ++::dbg_util::thread_counts().operator_news;                               \
+    if (auto p = std::malloc(size ? size : 1)) {                               \
+      return p;                                                                \
+    }                                                                          \
+    throw std::bad_alloc();                                                    \
+  }                                                                            \
+  void operator delete(void *p) noexcept {                                     \
+    if (p) {                                                                   \
+      ++::dbg_util::thread_counts().operator_deletes;                          \
+    }                                                                          \
+    std::free(p);                                                              \
+  }                                                                            \
+  void operator delete(void *p, std::size_t) noexcept {                        \
+    ::operator delete(p);                                                      \
+  }                                                                            \
+  void operator delete[](void *p) noexcept { ::operator delete(p); }           \
+  void operator delete[](void *p, std::size_t) noexcept {                      \
+    ::operator delete(p);                                                      \
+  }
+
+} // namespace dbg_util
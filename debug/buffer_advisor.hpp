@@ -0,0 +1,288 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file buffer_advisor.hpp
+ * Buffer sizes chosen from a profile of the models placed at run time.
+ *
+ * A program built with ERASURE_SPILL_TELEMETRY writes its placements with
+ * write_spill_profile() (or write_spill_profile_at_exit()): one line per
+ * (any type, value type), with the model's size and alignment and how often
+ * it was placed. The buffer_advisor tool (tools/) reads such profiles and,
+ * for every any type, picks the buffer size with the least estimated cost
+ *
+ *     placements * handle bytes + allocation weight * heap placements,
+ *
+ * where the allocation weight says how many handle bytes one heap allocation
+ * is worth. Naming an any type with name_any() lets the tool emit a header
+ * of `buffer_size` aliases for it.
+ */
+
+#include "demangle.hpp"
+
+#include "erasure/telemetry.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <typeindex>
+#include <vector>
+
+namespace dbg_util {
+
+namespace detail {
+struct any_names {
+  std::mutex mutex;
+  std::map<std::type_index, std::string> names;
+};
+template <typename = void>
+any_names any_names_;
+
+/** Reads all of field as a decimal number into n. */
+template <typename Number>
+auto parse_number(std::string const &field, Number &n) -> bool {
+  auto const end = field.data() + field.size();
+  auto const [stop, error] = std::from_chars(field.data(), end, n);
+  return error == std::errc{} && stop == end;
+}
+} // namespace detail
+
+/**
+ * Names an any type in profiles. The name is what the generated header calls
+ * the advised buffer size, so it should be an identifier.
+ */
+template <typename Any>
+void name_any(std::string name) {
+  auto &n = detail::any_names_<>;
+  std::lock_guard<std::mutex> lock(n.mutex);
+  n.names[typeid(Any)] = std::move(name);
+}
+
+/** One (any type, value type) of a profile. */
+struct profile_entry {
+  /** The name given with name_any(), or empty. */
+  std::string name;
+  std::string any_type;
+  std::string value_type;
+  std::size_t model_size;
+  std::size_t model_align;
+  std::size_t capacity;
+  std::uint64_t inline_placements;
+  std::uint64_t heap_placements;
+
+  auto placements() const -> std::uint64_t {
+    return inline_placements + heap_placements;
+  }
+};
+
+constexpr char const spill_profile_header[] = "# erasure spill profile 1";
+
+/**
+ * Writes the placements counted so far, one tab-separated line per
+ * (any type, value type), after a header line.
+ */
+inline void write_spill_profile(
+    std::ostream &o, std::vector<erasure::telemetry::site_report> const
+                         &sites = erasure::telemetry::report()) {
+  auto &n = detail::any_names_<>;
+  std::lock_guard<std::mutex> lock(n.mutex);
+  o << spill_profile_header << "\n";
+  for (auto const &s : sites) {
+    auto const name = n.names.find(*s.any_type);
+    o << (name == n.names.end() ? "-" : name->second) << "\t"
+      << demangle(s.any_type->name()) << "\t"
+      << demangle(s.value_type->name()) << "\t" << s.model_size << "\t"
+      << s.model_align << "\t" << s.capacity << "\t" << s.inline_placements
+      << "\t" << s.heap_placements << "\n";
+  }
+}
+
+/** Writes the spill profile to the file at `path` when the program exits. */
+inline void write_spill_profile_at_exit(std::string path) {
+  static std::string at_exit_path;
+  static bool const registered = std::atexit([] {
+    std::ofstream out(at_exit_path);
+    write_spill_profile(out);
+  }) == 0;
+  (void)registered;
+  at_exit_path = std::move(path);
+}
+
+/**
+ * Reads a profile written by write_spill_profile(). Returns false, having
+ * read what came before, on a line it does not understand.
+ */
+inline auto read_spill_profile(std::istream &in,
+                               std::vector<profile_entry> &entries) -> bool {
+  std::string line;
+  if (!std::getline(in, line) || line != spill_profile_header) {
+    return false;
+  }
+  while (std::getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::istringstream columns(line);
+    for (std::string field; std::getline(columns, field, '\t');) {
+      fields.push_back(field);
+    }
+    if (fields.size() != 8) {
+      return false;
+    }
+    profile_entry e{fields[0] == "-" ? std::string() : fields[0],
+                    fields[1],
+                    fields[2],
+                    0,
+                    0,
+                    0,
+                    0,
+                    0};
+    if (!detail::parse_number(fields[3], e.model_size) ||
+        !detail::parse_number(fields[4], e.model_align) ||
+        !detail::parse_number(fields[5], e.capacity) ||
+        !detail::parse_number(fields[6], e.inline_placements) ||
+        !detail::parse_number(fields[7], e.heap_placements)) {
+      return false;
+    }
+    entries.push_back(std::move(e));
+  }
+  return true;
+}
+
+/** The buffer size recommended for one any type. */
+struct buffer_advice {
+  std::string name;
+  std::string any_type;
+  std::uint64_t placements;
+  std::size_t capacity;
+  std::uint64_t heap_placements;
+  double cost;
+  std::size_t advised_capacity;
+  std::uint64_t advised_heap_placements;
+  double advised_cost;
+};
+
+/** sizeof an any with a buffer of `capacity` bytes. */
+inline auto handle_size(std::size_t capacity) -> std::size_t {
+  auto const pointer = sizeof(void *);
+  return pointer + (capacity + pointer - 1) / pointer * pointer;
+}
+
+/**
+ * The buffer bytes a model needs to be placed inline wherever the any is;
+ * see erasure::layout_for::footprint.
+ */
+inline auto footprint(profile_entry const &e) -> std::size_t {
+  auto const pointer = alignof(void *);
+  return e.model_size + (e.model_align > pointer ? e.model_align - pointer : 0);
+}
+
+/**
+ * Recommends a buffer size for every any type in the profile: the smallest
+ * multiple of a pointer's size with the least cost (see the file comment).
+ * Entries of the same any type, from several profiles, are added up.
+ * The any types that would gain most come first.
+ */
+inline auto advise_buffer_sizes(std::vector<profile_entry> const &entries,
+                                double allocation_weight)
+    -> std::vector<buffer_advice> {
+  std::map<std::string, std::vector<profile_entry const *>> by_any;
+  for (auto const &e : entries) {
+    by_any[e.any_type].push_back(&e);
+  }
+  std::vector<buffer_advice> result;
+  for (auto const &[any_type, sites] : by_any) {
+    auto const heap_at = [&sites](std::size_t capacity) {
+      std::uint64_t heap = 0;
+      for (auto const s : sites) {
+        heap += footprint(*s) > capacity ? s->placements() : 0;
+      }
+      return heap;
+    };
+    auto const cost_at = [&](std::size_t capacity, std::uint64_t heap,
+                             std::uint64_t placements) {
+      return static_cast<double>(placements) * handle_size(capacity) +
+             allocation_weight * static_cast<double>(heap);
+    };
+
+    buffer_advice a{};
+    a.any_type = any_type;
+    std::size_t largest = 0;
+    for (auto const s : sites) {
+      if (a.name.empty()) {
+        a.name = s->name;
+      }
+      a.placements += s->placements();
+      a.heap_placements += s->heap_placements;
+      a.capacity = s->capacity;
+      largest = std::max(largest, footprint(*s));
+    }
+    a.cost = cost_at(a.capacity, a.heap_placements, a.placements);
+    a.advised_cost = -1;
+    for (std::size_t capacity = 0; capacity <= largest + sizeof(void *) - 1;
+         capacity += sizeof(void *)) {
+      auto const heap = heap_at(capacity);
+      auto const cost = cost_at(capacity, heap, a.placements);
+      if (a.advised_cost < 0 || cost < a.advised_cost) {
+        a.advised_capacity = capacity;
+        a.advised_heap_placements = heap;
+        a.advised_cost = cost;
+      }
+    }
+    result.push_back(std::move(a));
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](buffer_advice const &x, buffer_advice const &y) {
+                     return x.cost - x.advised_cost > y.cost - y.advised_cost;
+                   });
+  return result;
+}
+
+/**
+ * Writes a header that defines, in namespace `ns`, an alias of the advised
+ * `erasure::buffer_size` for every named any type. Unnamed ones are listed
+ * in comments.
+ */
+inline void write_buffer_size_header(std::ostream &o,
+                                     std::vector<buffer_advice> const &advice,
+                                     std::string const &ns,
+                                     double allocation_weight) {
+  o << "// Generated by buffer_advisor, allocation weight " << allocation_weight
+    << ".\n#pragma once\n\n#include \"erasure/erasure.hpp\"\n\nnamespace " << ns
+    << " {\n";
+  for (auto const &a : advice) {
+    o << "// " << a.any_type << ": " << a.placements << " placements, "
+      << a.heap_placements << " on heap at " << a.capacity << " bytes, "
+      << a.advised_heap_placements << " at " << a.advised_capacity << "\n";
+    if (!a.name.empty()) {
+      o << "using " << a.name << " = erasure::buffer_size<"
+        << a.advised_capacity << ">;\n";
+    }
+  }
+  o << "} // namespace " << ns << "\n";
+}
+
+} // namespace dbg_util
@@ -16,7 +16,7 @@
 
 #pragma once
 
-// #include "boost/core/demangle.hpp"
+#include "erasure/demangle.hpp"
 
 #include <string>
 #include <typeinfo>
@@ -24,8 +24,8 @@
 #include <vector>
 
 namespace dbg_util {
-auto replace_all(std::string in_what, std::string const &what,
-                 std::string const &with) -> std::string {
+inline auto replace_all(std::string in_what, std::string const &what,
+                        std::string const &with) -> std::string {
   auto where = in_what.find(what);
   while (where != std::string::npos) {
     in_what.replace(where, what.size(), with);
@@ -43,18 +43,23 @@ auto replace_all(std::string in_what, std::string const &what,
  *
  * Also compresses old-style template endings with spaces between the >'s with
  * no spaces.
+ *
+ * Names are demangled by erasure::detail::demangle.
  */
-auto demangle(char const *const name) -> std::string {
+inline auto demangle(char const *const name) -> std::string {
   using std::make_pair;
   using std::move;
   using std::pair;
   using std::string;
   using std::vector;
-  string demangled = name;
+  string demangled = erasure::detail::demangle(name);
   static vector<pair<string, string>> const replacements{
       {"std::__1::basic_string<char, std::__1::char_traits<char>, "
        "std::__1::allocator<char> >",
        "std::string"},
+      {"std::__cxx11::basic_string<char, std::char_traits<char>, "
+       "std::allocator<char> >",
+       "std::string"},
       {" >", ">"}};
   for (auto const &replacement : replacements) {
     demangled =
@@ -17,92 +17,33 @@
 #pragma once
 
 #include "demangle.hpp"
+#include "trace.hpp"
 
-#include <cassert>
+#include <atomic>
 #include <cstdint>
 #include <iostream>
-#include <tuple>
-#include <vector>
+#include <typeinfo>
 
 namespace dbg_util {
 
-enum class operation {
-  DEFAULT_CONSTRUCTION,
-  VALUE_CONSTRUCTION,
-  COPY_CONSTRUCTION,
-  MOVE_CONSTRUCTION,
-  COPY_ASSIGNMENT,
-  MOVE_ASSIGNMENT,
-  DESTRUCTION,
-  SWAP,
-  EQUALS
-};
-auto operator<<(std::ostream &out, operation op) -> std::ostream & {
-  switch (op) {
-  case operation::DEFAULT_CONSTRUCTION:
-    return out << "DEFAULT_CONSTRUCTION";
-  case operation::VALUE_CONSTRUCTION:
-    return out << "VALUE_CONSTRUCTION";
-  case operation::COPY_CONSTRUCTION:
-    return out << "COPY_CONSTRUCTION";
-  case operation::MOVE_CONSTRUCTION:
-    return out << "MOVE_CONSTRUCTION";
-  case operation::COPY_ASSIGNMENT:
-    return out << "COPY_ASSIGNMENT";
-  case operation::MOVE_ASSIGNMENT:
-    return out << "MOVE_ASSIGNMENT";
-  case operation::DESTRUCTION:
-    return out << "DESTRUCTION";
-  case operation::SWAP:
-    return out << "SWAP";
-  case operation::EQUALS:
-    return out << "EQUALS";
-  }
-  assert(false && "Unreachable");
-}
-
 template <typename T>
 struct instrumented;
 
 template <typename>
-uint64_t current_id = 0;
-inline auto get_id() -> uint64_t { return current_id<void> ++; }
-inline void reset_numbering() { current_id<void> = 0; }
-
-template <typename>
-std::vector<std::tuple<uint64_t, uint64_t, operation>> trace_ = {};
+std::atomic<uint64_t> current_id{0};
+inline auto get_id() -> uint64_t {
+  return current_id<void>.fetch_add(1, std::memory_order_relaxed);
+}
+inline void reset_numbering() { current_id<void>.store(0); }
 
-inline auto trace() -> auto & { return trace_<void>; }
 template <typename T, typename U>
 inline void add_to_trace(instrumented<T> const &x, instrumented<U> const &y,
                          operation op) {
-  trace().emplace_back(x.id, y.id, op);
+  record_trace(x.id, y.id, typeid(T).name(), op);
 }
 template <typename T>
 inline void add_to_trace(instrumented<T> const &x, operation op) {
-  trace().emplace_back(x.id, -1, op);
-}
-inline void clear_trace() { trace().clear(); }
-using trace_type = std::decay_t<decltype(trace())>;
-template <typename... Tuples>
-auto tuples_to_trace(Tuples const &... ts) {
-  return trace_type{ts...};
-}
-template <typename... Tuples>
-auto trace_is(Tuples const &... ts) -> bool {
-  return trace() == tuples_to_trace(ts...);
-}
-
-void print_trace(std::ostream &o, trace_type const &t = trace()) {
-  using std::get;
-  for (auto const &line : t) {
-    if (get<1>(line) == static_cast<decltype(get<1>(line))>(-1)) {
-      o << "[trace]: " << get<2>(line) << " on " << get<0>(line) << "\n";
-    } else {
-      o << "[trace]: " << get<2>(line) << " between " << get<0>(line) << " and "
-        << get<1>(line) << "\n";
-    }
-  }
+  record_trace(x.id, no_id, typeid(T).name(), op);
 }
 
 namespace detail {
@@ -174,23 +115,4 @@ auto make_instrumented(T &&x) {
   return instrumented<std::decay_t<T>>{std::forward<T>(x)};
 }
 
-template <typename... Tuples>
-void assert_trace_is_and_clear_(std::string const &file, int line,
-                                Tuples const &... ts) {
-  if (!dbg_util::trace_is(ts...)) {
-    std::cerr << "Asstion assert_trace_is_and_clear() at " << file << ":"
-              << line << " falied.\n"
-              << "Trace:\n"
-              << "^^^^^^\n";
-    dbg_util::print_trace(std::cerr);
-    std::cerr << "Expected trace:\n"
-              << "^^^^^^^^^^^^^^^\n";
-    dbg_util::print_trace(std::cerr, dbg_util::tuples_to_trace(ts...));
-    exit(1);
-  }
-  dbg_util::clear_trace();
-}
-#define ASSERT_AND_CLEAR_TRACE_IS(...)                                         \
-  ::dbg_util::assert_trace_is_and_clear_(__FILE__, __LINE__, __VA_ARGS__)
-
 } // namespace dbg_util
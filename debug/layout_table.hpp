@@ -0,0 +1,60 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file layout_table.hpp
+ * Printing of erasure::layout and erasure::layout_for as a table.
+ */
+
+#include "demangle.hpp"
+
+#include "erasure/layout.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+
+namespace dbg_util {
+
+/**
+ * Prints the handle of Any, then one row per value type: its size, its
+ * model's size and alignment, and whether it is placed inline (or else, how
+ * many bytes the buffer is short).
+ */
+template <typename Any, typename... Ts>
+void print_layout_table(std::ostream &o) {
+  using any_layout = erasure::layout<Any>;
+  o << "[layout]: handle " << any_layout::handle_size << " bytes, buffer "
+    << any_layout::capacity << " bytes (values up to "
+    << any_layout::value_capacity << " bytes), " << any_layout::features
+    << " features, " << any_layout::vtable_slots << " vtable slots\n";
+  o << "[layout]:" << std::setw(8) << "value" << std::setw(8) << "model"
+    << std::setw(8) << "align" << std::setw(8) << "inline"
+    << "  value type\n";
+  auto const row = [&o](auto l, std::type_info const &type) {
+    using T = decltype(l);
+    o << "[layout]:" << std::setw(8) << T::value_size << std::setw(8)
+      << T::model_size << std::setw(8) << T::model_align << std::setw(8)
+      << (T::fits_inline ? std::string("yes")
+                         : "+" + std::to_string(T::missing_bytes))
+      << "  " << demangle(type.name()) << "\n";
+  };
+  (row(erasure::layout_for<Any, Ts>{}, typeid(Ts)), ...);
+}
+
+} // namespace dbg_util
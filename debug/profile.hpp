@@ -0,0 +1,51 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file profile.hpp
+ * Printing of the counts collected by `profiled<F>` features.
+ */
+
+#include "demangle.hpp"
+
+#include "erasure/profiling.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace dbg_util {
+
+/**
+ * Prints one line per (feature, value type): calls, timed calls and their
+ * mean duration in ns.
+ */
+inline void print_profile(std::ostream &o,
+                          std::vector<erasure::profiling::call_site> const
+                              &sites = erasure::profiling::snapshot()) {
+  for (auto const &site : sites) {
+    o << "[profile]: " << demangle(site.feature->name()) << " on "
+      << demangle(site.value->name()) << ": " << site.calls << " calls";
+    if (site.sampled_calls) {
+      o << ", " << site.sampled_calls << " timed, mean " << std::fixed
+        << std::setprecision(1) << site.mean_ns() << " ns";
+    }
+    o << "\n";
+  }
+}
+
+} // namespace dbg_util
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file spill_report.hpp
+ * Printing of the spill telemetry collected with ERASURE_SPILL_TELEMETRY.
+ */
+
+#include "demangle.hpp"
+
+#include "erasure/telemetry.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace dbg_util {
+
+/**
+ * Prints one line per (any type, value type) with its placements, and a
+ * histogram of model sizes.
+ */
+inline void print_spill_report(
+    std::ostream &o, std::vector<erasure::telemetry::site_report> const
+                         &sites = erasure::telemetry::report()) {
+  for (auto const &s : sites) {
+    o << "[spill]: " << demangle(s.value_type->name()) << " in "
+      << demangle(s.any_type->name()) << ": " << s.heap_placements
+      << " on heap, " << s.inline_placements << " inline; model "
+      << s.model_size << " bytes, buffer " << s.capacity << " bytes";
+    if (s.missing_bytes()) {
+      o << " (" << s.missing_bytes() << " short)";
+    }
+    o << "\n";
+  }
+  for (auto const &b : erasure::telemetry::size_histogram(sites)) {
+    o << "[spill]: models of <= " << b.upper << " bytes: " << b.heap_placements
+      << " on heap, " << b.inline_placements << " inline\n";
+  }
+}
+
+/** Prints the spill report to std::cerr when the program exits. */
+inline void print_spill_report_at_exit() {
+  static bool const registered =
+      std::atexit([] { print_spill_report(std::cerr); }) == 0;
+  (void)registered;
+}
+
+} // namespace dbg_util
@@ -0,0 +1,393 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file trace.hpp
+ * The operation trace that instrumented<T> writes.
+ *
+ * Every thread records into its own ring buffer of timestamped records, so
+ * recording takes no lock and is a handful of stores. When a ring is full,
+ * its oldest records are overwritten (see set_trace_capacity()).
+ *
+ * Reading - trace(), trace_records(), write_chrome_trace() - merges the rings
+ * of all threads, keeping every thread's records in the order it wrote them
+ * and interleaving threads by time stamp. Reading while other threads record
+ * is safe: every slot of a ring carries a sequence number, so that records
+ * overwritten while they are read are dropped. The newest records of threads
+ * that are still recording may not be seen yet.
+ *
+ * The ring of a thread that exits keeps its records until a new thread takes
+ * it over, so there are only as many rings as threads were ever alive at
+ * once.
+ *
+ * clear_trace() discards everything recorded so far, on all threads.
+ */
+
+#include "demangle.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace dbg_util {
+
+enum class operation {
+  DEFAULT_CONSTRUCTION,
+  VALUE_CONSTRUCTION,
+  COPY_CONSTRUCTION,
+  MOVE_CONSTRUCTION,
+  COPY_ASSIGNMENT,
+  MOVE_ASSIGNMENT,
+  DESTRUCTION,
+  SWAP,
+  EQUALS
+};
+inline auto operation_name(operation op) -> char const * {
+  switch (op) {
+  case operation::DEFAULT_CONSTRUCTION:
+    return "DEFAULT_CONSTRUCTION";
+  case operation::VALUE_CONSTRUCTION:
+    return "VALUE_CONSTRUCTION";
+  case operation::COPY_CONSTRUCTION:
+    return "COPY_CONSTRUCTION";
+  case operation::MOVE_CONSTRUCTION:
+    return "MOVE_CONSTRUCTION";
+  case operation::COPY_ASSIGNMENT:
+    return "COPY_ASSIGNMENT";
+  case operation::MOVE_ASSIGNMENT:
+    return "MOVE_ASSIGNMENT";
+  case operation::DESTRUCTION:
+    return "DESTRUCTION";
+  case operation::SWAP:
+    return "SWAP";
+  case operation::EQUALS:
+    return "EQUALS";
+  }
+  assert(false && "Unreachable");
+  return "";
+}
+inline auto operator<<(std::ostream &out, operation op) -> std::ostream & {
+  return out << operation_name(op);
+}
+
+/** The id of the other object of unary operations. */
+constexpr std::uint64_t no_id = static_cast<std::uint64_t>(-1);
+
+struct trace_record {
+  /** Time stamp counter ticks on x86, steady clock ns elsewhere. */
+  std::uint64_t ticks;
+  std::uint64_t id;
+  std::uint64_t other;
+  /** The mangled name of the traced value's type. */
+  char const *type;
+  operation op;
+  /** The index of the recording thread, in order of first record. */
+  std::uint32_t thread;
+};
+
+namespace detail {
+inline auto trace_ticks() -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+inline auto steady_ns() -> std::uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * A trace_record that one thread writes while others read it. seq is
+ * 2 * (index + 1) once the record with that index is written, and odd while
+ * a record is being written.
+ */
+struct trace_slot {
+  std::atomic<std::uint64_t> seq{0};
+  std::atomic<std::uint64_t> ticks;
+  std::atomic<std::uint64_t> id;
+  std::atomic<std::uint64_t> other;
+  std::atomic<char const *> type;
+  std::atomic<operation> op;
+  std::atomic<std::uint32_t> thread;
+};
+
+/** One thread's records. Only the owning thread writes. */
+struct trace_ring {
+  trace_ring(std::size_t capacity, std::uint32_t thread)
+      : slots(capacity), thread(thread) {}
+
+  void push(trace_record const &r) {
+    auto const h = head.load(std::memory_order_relaxed);
+    auto &slot = slots[h & (slots.size() - 1)];
+    constexpr auto relaxed = std::memory_order_relaxed;
+    slot.seq.store(2 * h + 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ticks.store(r.ticks, relaxed);
+    slot.id.store(r.id, relaxed);
+    slot.other.store(r.other, relaxed);
+    slot.type.store(r.type, relaxed);
+    slot.op.store(r.op, relaxed);
+    slot.thread.store(r.thread, relaxed);
+    slot.seq.store(2 * h + 2, std::memory_order_release);
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  std::vector<trace_slot> slots;
+  /** Records ever written. */
+  std::atomic<std::uint64_t> head{0};
+  /** Records before this one were cleared. */
+  std::atomic<std::uint64_t> cleared{0};
+  /** The index of the thread that records into it now. */
+  std::uint32_t thread;
+};
+
+struct trace_registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<trace_ring>> rings;
+  /** Rings of threads that exited, for new threads to take over. */
+  std::vector<trace_ring *> retired;
+  std::uint32_t threads = 0;
+  std::size_t capacity = std::size_t{1} << 16;
+  /** When tracing started, to convert ticks to time. */
+  std::uint64_t start_ticks = trace_ticks();
+  std::uint64_t start_ns = steady_ns();
+};
+template <typename = void>
+trace_registry trace_registry_;
+
+[[gnu::noinline]] inline auto new_trace_ring() -> trace_ring * {
+  auto &r = trace_registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  auto const thread = r.threads++;
+  auto const reusable =
+      std::find_if(r.retired.begin(), r.retired.end(), [&](trace_ring *ring) {
+        return ring->slots.size() == r.capacity;
+      });
+  if (reusable != r.retired.end()) {
+    auto const ring = *reusable;
+    r.retired.erase(reusable);
+    ring->thread = thread;
+    return ring;
+  }
+  r.rings.push_back(std::make_unique<trace_ring>(r.capacity, thread));
+  return r.rings.back().get();
+}
+
+/** Retires the thread's ring when the thread exits. */
+struct trace_ring_owner {
+  trace_ring *ring = nullptr;
+
+  ~trace_ring_owner() {
+    if (ring) {
+      auto &r = trace_registry_<>;
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.retired.push_back(ring);
+    }
+  }
+};
+
+inline auto this_thread_ring() -> trace_ring & {
+  thread_local trace_ring_owner owner;
+  if (!owner.ring) [[unlikely]] {
+    owner.ring = new_trace_ring();
+  }
+  return *owner.ring;
+}
+
+/** The uncleared records of one ring that were not overwritten. */
+inline auto read_ring(trace_ring const &ring) -> std::vector<trace_record> {
+  auto const capacity = ring.slots.size();
+  auto const head = ring.head.load(std::memory_order_acquire);
+  auto first = std::max(ring.cleared.load(std::memory_order_relaxed),
+                        head > capacity ? head - capacity : 0);
+  std::vector<trace_record> result;
+  constexpr auto relaxed = std::memory_order_relaxed;
+  for (auto i = first; i < head; ++i) {
+    auto const &slot = ring.slots[i & (capacity - 1)];
+    auto const seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * i + 2) {
+      continue; // overwritten by a newer record, or being overwritten
+    }
+    trace_record const r{slot.ticks.load(relaxed), slot.id.load(relaxed),
+                         slot.other.load(relaxed), slot.type.load(relaxed),
+                         slot.op.load(relaxed),    slot.thread.load(relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(relaxed) == seq) {
+      result.push_back(r);
+    }
+  }
+  return result;
+}
+} // namespace detail
+
+/**
+ * The number of records each thread keeps, rounded up to a power of two.
+ * Applies to threads that have not recorded yet.
+ */
+inline void set_trace_capacity(std::size_t records) {
+  std::size_t capacity = 1;
+  while (capacity < records) {
+    capacity *= 2;
+  }
+  auto &r = detail::trace_registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.capacity = capacity;
+}
+
+inline void record_trace(std::uint64_t id, std::uint64_t other,
+                         char const *type, operation op) {
+  auto &ring = detail::this_thread_ring();
+  ring.push({detail::trace_ticks(), id, other, type, op, ring.thread});
+}
+
+/** The records of all threads, merged. */
+inline auto trace_records() -> std::vector<trace_record> {
+  std::vector<std::vector<trace_record>> per_thread;
+  {
+    auto &r = detail::trace_registry_<>;
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto const &ring : r.rings) {
+      per_thread.push_back(detail::read_ring(*ring));
+    }
+  }
+  std::vector<trace_record> merged;
+  std::vector<std::size_t> next(per_thread.size(), 0);
+  for (;;) {
+    std::size_t best = per_thread.size();
+    for (std::size_t t = 0; t < per_thread.size(); ++t) {
+      if (next[t] < per_thread[t].size() &&
+          (best == per_thread.size() ||
+           per_thread[t][next[t]].ticks < per_thread[best][next[best]].ticks)) {
+        best = t;
+      }
+    }
+    if (best == per_thread.size()) {
+      return merged;
+    }
+    merged.push_back(per_thread[best][next[best]++]);
+  }
+}
+
+inline void clear_trace() {
+  auto &r = detail::trace_registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto const &ring : r.rings) {
+    ring->cleared.store(ring->head.load(std::memory_order_acquire),
+                        std::memory_order_relaxed);
+  }
+}
+
+using trace_type = std::vector<std::tuple<uint64_t, uint64_t, operation>>;
+
+/** The merged trace as (id, other id, operation) triples. */
+inline auto trace() -> trace_type {
+  trace_type result;
+  for (auto const &r : trace_records()) {
+    result.emplace_back(r.id, r.other, r.op);
+  }
+  return result;
+}
+
+template <typename... Tuples>
+auto tuples_to_trace(Tuples const &... ts) {
+  return trace_type{ts...};
+}
+template <typename... Tuples>
+auto trace_is(Tuples const &... ts) -> bool {
+  return trace() == tuples_to_trace(ts...);
+}
+
+inline void print_trace(std::ostream &o, trace_type const &t = trace()) {
+  using std::get;
+  for (auto const &line : t) {
+    if (get<1>(line) == no_id) {
+      o << "[trace]: " << get<2>(line) << " on " << get<0>(line) << "\n";
+    } else {
+      o << "[trace]: " << get<2>(line) << " between " << get<0>(line) << " and "
+        << get<1>(line) << "\n";
+    }
+  }
+}
+
+/**
+ * Writes the records in the Chrome trace event format, which
+ * chrome://tracing and Perfetto open: one instant event per record, on the
+ * recording thread's track, named after the operation.
+ */
+inline void write_chrome_trace(
+    std::ostream &o, std::vector<trace_record> const &records = trace_records()) {
+  auto &r = detail::trace_registry_<>;
+  auto const ns = detail::steady_ns() - r.start_ns;
+  auto const ticks = detail::trace_ticks() - r.start_ticks;
+  auto const us_per_tick = ticks ? 1e-3 * ns / ticks : 1e-3;
+  auto const escaped = [](std::string s) {
+    s = replace_all(std::move(s), "\\", "\\\\");
+    return replace_all(std::move(s), "\"", "\\\"");
+  };
+  o << "{\"traceEvents\":[";
+  char const *separator = "\n";
+  for (auto const &record : records) {
+    o << separator << "{\"name\":\"" << record.op
+      << "\",\"cat\":\"erasure\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":"
+      << record.thread << ",\"ts\":" << std::fixed
+      << (record.ticks - r.start_ticks) * us_per_tick << ",\"args\":{\"id\":"
+      << record.id;
+    if (record.other != no_id) {
+      o << ",\"other\":" << record.other;
+    }
+    o << ",\"type\":\"" << escaped(demangle(record.type)) << "\"}}";
+    separator = ",\n";
+  }
+  o << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+template <typename... Tuples>
+void assert_trace_is_and_clear_(std::string const &file, int line,
+                                Tuples const &... ts) {
+  if (!dbg_util::trace_is(ts...)) {
+    std::cerr << "Asstion assert_trace_is_and_clear() at " << file << ":"
+              << line << " falied.\n"
+              << "Trace:\n"
+              << "^^^^^^\n";
+    dbg_util::print_trace(std::cerr);
+    std::cerr << "Expected trace:\n"
+              << "^^^^^^^^^^^^^^^\n";
+    dbg_util::print_trace(std::cerr, dbg_util::tuples_to_trace(ts...));
+    exit(1);
+  }
+  dbg_util::clear_trace();
+}
+#define ASSERT_AND_CLEAR_TRACE_IS(...)                                         \
+  ::dbg_util::assert_trace_is_and_clear_(__FILE__, __LINE__, __VA_ARGS__)
+
+} // namespace dbg_util
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file arena.hpp
+ * Models of an any type in one arena, named by 32-bit handles.
+ *
+ * An arena<Any> reserves one block of memory up front and places the models
+ * of Any's feature set in it, one after the other, each starting with its
+ * vtable pointer. An arena_any<Any> is the model's offset in the block in
+ * units of arena<Any>::granule, so four bytes name a model in an arena of up
+ * to 32 GiB. Dereferencing a handle loads the block's address and, to
+ * dispatch, the model's vtable pointer.
+ *
+ * Handles don't know their arena, so the features are used through it:
+ *
+ *     erasure::arena<shape> shapes(1 << 20);
+ *     auto const c = shapes.emplace(circle{1});
+ *     auto const area = shapes.call<area_feature>(c);
+ *     shape copy = shapes.get(c);  // a full any, with the whole interface
+ *
+ * The arena is append only: models live until clear() or the arena's
+ * destruction, which destroy all of them.
+ */
+
+#include "erasure.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace erasure {
+
+/** A model in an arena<Any>; the null handle is no model at all. */
+template <typename Any>
+struct arena_any {
+  std::uint32_t offset = 0;
+
+  explicit operator bool() const { return offset != 0; }
+  friend auto operator==(arena_any, arena_any) -> bool = default;
+};
+
+template <typename Any>
+class arena {
+public:
+  using handle = arena_any<Any>;
+  using vtbl = typename detail::any_interface_t<
+      detail::get_options<Any>>::vtbl;
+  template <typename T>
+  using model = typename detail::any_interface_t<
+      detail::get_options<Any>>::template model<T>;
+
+  /** Models start at multiples of this, which is also their largest
+   * alignment. */
+  static constexpr std::size_t granule = alignof(void *);
+  static constexpr std::size_t max_capacity =
+      (std::size_t{1} << 32) * granule;
+
+  /**
+   * Reserves capacity bytes. Pages the arena never touches usually cost no
+   * memory, so it is fine to ask for more than is needed. Throws
+   * std::length_error for more than max_capacity, which 32-bit handles can't
+   * name.
+   */
+  explicit arena(std::size_t capacity) : capacity_{round_up(capacity)} {
+    if (capacity_ > max_capacity) {
+      throw std::length_error("arena capacity over max_capacity");
+    }
+    base_ = static_cast<char *>(std::malloc(capacity_));
+    if (!base_) {
+      throw std::bad_alloc{};
+    }
+  }
+  arena(arena const &) = delete;
+  auto operator=(arena const &) -> arena & = delete;
+  ~arena() {
+    clear();
+    std::free(base_);
+  }
+
+  /**
+   * Places a model of T, constructed from value. If that throws, the arena is
+   * left as it was.
+   */
+  template <typename T>
+  auto emplace(T &&value) -> handle {
+    using m = model<std::remove_cvref_t<T>>;
+    static_assert(alignof(m) <= granule, "Over-aligned values don't fit.");
+    return place(sizeof(m), [&](ubuf::buffer_t buf) {
+      detail::make_model<m>(buf, std::forward<T>(value));
+    });
+  }
+
+  /** Places a copy of x's model; an empty x gives the null handle. */
+  auto insert(Any const &x) -> handle {
+    return insert_model<detail::copy_construct_in>(erasure::concept_ptr(x));
+  }
+  /** Moves x's model in; x keeps its moved-from value. */
+  auto insert(Any &&x) -> handle {
+    return insert_model<detail::move_construct_in>(erasure::concept_ptr(x));
+  }
+  /** Places a copy of the model behind h, which may be in another arena. */
+  auto insert(arena const &from, handle h) -> handle {
+    return insert_model<detail::copy_construct_in>(from.concept_ptr(h));
+  }
+
+  /** The model behind h, or nullptr for the null handle. */
+  auto concept_ptr(handle h) -> vtbl * {
+    return h ? static_cast<vtbl *>(address(h)) : nullptr;
+  }
+  auto concept_ptr(handle h) const -> vtbl const * {
+    return h ? static_cast<vtbl const *>(address(h)) : nullptr;
+  }
+
+  /** Calls the feature Tag on the model behind h, like erasure::call. */
+  template <typename Tag, typename... As>
+  auto call(handle h, As &&... as) -> decltype(auto) {
+#ifdef ERASURE_HOOKS
+    hooks::notify_dispatched<tag_t<Tag>>();
+#endif
+    return concept_ptr(h)->erase(tag<Tag>, (As &&) as...);
+  }
+  template <typename Tag, typename... As>
+  auto call(handle h, As &&... as) const -> decltype(auto) {
+#ifdef ERASURE_HOOKS
+    hooks::notify_dispatched<tag_t<Tag>>();
+#endif
+    return concept_ptr(h)->erase(tag<Tag>, (As &&) as...);
+  }
+
+  /** The value behind h if it is a T, else nullptr. */
+  template <typename T>
+  auto target(handle h) const -> T const * {
+    if (!h) {
+      return nullptr;
+    }
+    using U = std::remove_cv_t<T>;
+    auto const v = call<detail::value_identity>(h);
+    return detail::is_type(v, typeid(U), detail::checked_type_hash<U>())
+               ? static_cast<T const *>(v.value)
+               : nullptr;
+  }
+  template <typename T>
+  auto target(handle h) -> T * {
+    return const_cast<T *>(std::as_const(*this).template target<T>(h));
+  }
+
+  /** Like erasure::same_dynamic_type on anys. */
+  auto same_dynamic_type(handle x, handle y) const -> bool {
+    if (!x || !y) {
+      return false;
+    }
+    if (detail::vtable_word(concept_ptr(x)) ==
+        detail::vtable_word(concept_ptr(y))) {
+      return true;
+    }
+    auto const vy = call<detail::value_identity>(y);
+    return detail::is_type(call<detail::value_identity>(x), *vy.type,
+                           vy.type_hash);
+  }
+
+  /** A copy of the value behind h, as an Any. */
+  auto get(handle h) const -> Any {
+    Any result;
+    if (h) {
+      call<detail::allocate_and_copy_construct_in>(h,
+                                                   detail::buffer_ref(result));
+      detail::refresh_caches(result);
+    }
+    return result;
+  }
+
+  /** Destroys all models; every handle into the arena dangles. */
+  void clear() {
+    for (auto offset = granule; offset < top_;) {
+      auto const m = reinterpret_cast<vtbl *>(base_ + offset);
+      auto const size = m->erase(tag<detail::sizeof_alignof>).size;
+#ifdef ERASURE_HOOKS
+      hooks::notify_dispatched<tag_t<hooks::destruction>>();
+#endif
+      m->~vtbl();
+      offset += round_up(size);
+    }
+    top_ = granule;
+  }
+
+  /** Bytes taken by models, and bytes reserved. */
+  auto size_bytes() const -> std::size_t { return top_ - granule; }
+  auto capacity_bytes() const -> std::size_t { return capacity_; }
+
+private:
+  static constexpr auto round_up(std::size_t size) -> std::size_t {
+    return (size + granule - 1) / granule * granule;
+  }
+
+  auto address(handle h) const -> void * { return base_ + h.offset * granule; }
+
+  // Offset 0 is the null handle, so the first granule stays unused.
+  auto reserve(std::size_t size) -> handle {
+    auto const start = top_;
+    auto const end = start + round_up(size);
+    if (end > capacity_) {
+      throw std::bad_alloc{};
+    }
+    top_ = end;
+    return handle{static_cast<std::uint32_t>(start / granule)};
+  }
+
+  /**
+   * Reserves size bytes and constructs a model in them; gives them back if
+   * construct throws, so that clear() never sees a model that isn't there.
+   */
+  template <typename Construct>
+  auto place(std::size_t size, Construct &&construct) -> handle {
+    auto const top = top_;
+    auto const h = reserve(size);
+    try {
+      construct(ubuf::buffer_t{address(h), size});
+    } catch (...) {
+      top_ = top;
+      throw;
+    }
+    return h;
+  }
+
+  template <typename ConstructIn, typename Vtbl>
+  auto insert_model(Vtbl *from) -> handle {
+    if (!from) {
+      return {};
+    }
+    auto const spec = from->erase(tag<detail::sizeof_alignof>);
+    assert(spec.align <= granule && "Over-aligned values don't fit.");
+    return place(spec.size, [&](ubuf::buffer_t buf) {
+      from->erase(tag<ConstructIn>, buf);
+    });
+  }
+
+  char *base_;
+  std::size_t top_ = granule;
+  std::size_t capacity_;
+};
+
+} // namespace erasure
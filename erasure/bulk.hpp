@@ -0,0 +1,281 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file bulk.hpp
+ * Making and copying many anys at once.
+ *
+ * make_anys<Tags...>(first, last) makes an any<Tags...> of every value in the
+ * range, and clone_range(src, dst) appends copies of the anys in src to dst.
+ * Both place all the models that spill out of the small buffer in a single
+ * heap block, which is freed when the last of them is destroyed; the anys
+ * are ordinary anys otherwise. make_anys knows the type of the values and
+ * constructs the models directly; clone_range copies trivially copyable
+ * models with memcpy, and asks for the size of a model only when its type
+ * differs from the one before.
+ */
+
+#include "erasure.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace erasure {
+namespace ubuf {
+/**
+ * A block of heap models placed together, which is freed with the last of
+ * them. Every model in it is preceded by a pointer to the block.
+ */
+struct bulk_block : bulk_header {
+  /**
+   * The models still alive. While the block is being filled, one for the
+   * filler, which adds the models it placed when it is done.
+   */
+  std::atomic<std::size_t> references{1};
+
+  bulk_block() : bulk_header{[](bulk_header *block) {
+    static_cast<bulk_block *>(block)->unref();
+  }} {}
+
+  /** The bytes before the slots. */
+  static constexpr auto header_size() -> std::size_t {
+    return (sizeof(bulk_block) + alignof(std::max_align_t) - 1) /
+           alignof(std::max_align_t) * alignof(std::max_align_t);
+  }
+
+  /** Allocates a block with room for bytes of model slots. */
+  static auto allocate(std::size_t bytes) -> bulk_block * {
+    auto const addr = std::malloc(header_size() + bytes);
+    if (!addr) {
+      throw std::bad_alloc{};
+    }
+#ifdef ERASURE_HOOKS
+    hooks::notify([&](hooks::observer &o) {
+      o.placed({typeid(bulk_block), header_size() + bytes,
+                alignof(std::max_align_t), 0, true});
+    });
+#endif
+    return new (addr) bulk_block;
+  }
+
+  /** Where the slots start. */
+  auto data() -> char * {
+    return reinterpret_cast<char *>(this) + header_size();
+  }
+
+  /**
+   * The end of the slot for a model of spec placed at cursor, and where in it
+   * the model goes. Models can be aligned up to std::max_align_t.
+   */
+  static auto slot(std::uintptr_t cursor, buffer_spec spec)
+      -> std::pair<std::uintptr_t, std::uintptr_t> {
+    auto const align = std::max(spec.align, alignof(bulk_header *));
+    auto const model =
+        (cursor + sizeof(bulk_header *) + align - 1) / align * align;
+    return {model, model + spec.size};
+  }
+
+  /** Marks the memory at model as a model of this block. */
+  auto place(void *model) -> void * {
+    bulk_header *const self = this;
+    std::memcpy(static_cast<char *>(model) - sizeof(self), &self, sizeof(self));
+    return model;
+  }
+
+  /** Drops one reference, and frees the block with the last one. */
+  void unref() {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+#ifdef ERASURE_HOOKS
+      hooks::notify_deallocated(this);
+#endif
+      this->~bulk_block();
+      std::free(this);
+    }
+  }
+};
+} // namespace ubuf
+
+namespace detail {
+/**
+ * Holds the filler's reference to a bulk_block until the block is full, and
+ * then hands it over to the models placed.
+ */
+struct bulk_fill {
+  ubuf::bulk_block *block;
+  std::uintptr_t cursor;
+  std::size_t placed = 0;
+
+  explicit bulk_fill(std::size_t bytes)
+      : block{ubuf::bulk_block::allocate(bytes)},
+        cursor{reinterpret_cast<std::uintptr_t>(block->data())} {}
+  bulk_fill(bulk_fill const &) = delete;
+  auto operator=(bulk_fill const &) -> bulk_fill & = delete;
+  ~bulk_fill() {
+    if (placed == 0) {
+      block->unref();
+    } else {
+      block->references.fetch_add(placed - 1, std::memory_order_relaxed);
+    }
+  }
+
+  /** The next slot, for a model of spec. */
+  auto next(ubuf::buffer_spec spec) -> ubuf::buffer_t {
+    auto const [model, end] = ubuf::bulk_block::slot(cursor, spec);
+    cursor = end;
+    return {block->place(reinterpret_cast<void *>(model)), spec.size};
+  }
+  /** Gives the model constructed in slot to the empty x. */
+  template <typename Any>
+  void adopt(Any &x, ubuf::buffer_t slot) {
+    buffer_ref(x).adopt_bulk(slot.data);
+    ++placed;
+    refresh_caches(x);
+  }
+};
+
+/** The bytes of the slots for n models of spec. */
+inline auto bulk_bytes(ubuf::buffer_spec spec, std::size_t n) -> std::size_t {
+  // the block's data is aligned like std::max_align_t
+  std::uintptr_t cursor = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    cursor = ubuf::bulk_block::slot(cursor, spec).second;
+  }
+  return cursor;
+}
+
+/**
+ * The spec of models of one type after another, asking the model only when
+ * its vtable differs from the one before.
+ */
+template <typename Concept>
+struct spec_cache {
+  void const *vtable = nullptr;
+  ubuf::buffer_spec spec{};
+
+  auto operator()(Concept const &model) -> ubuf::buffer_spec {
+    auto const word = vtable_word(&model);
+    if (word != vtable) {
+#ifdef ERASURE_HOOKS
+      hooks::notify_dispatched<tag_t<sizeof_alignof>>();
+#endif
+      spec = model.erase(tag<sizeof_alignof>);
+      vtable = word;
+    }
+    return spec;
+  }
+};
+} // namespace detail
+
+/**
+ * Makes an any<Tags...> of every value in [first, last). Models that spill
+ * share one allocation.
+ */
+template <typename... Tags, typename Iterator>
+auto make_anys(Iterator first, Iterator last) -> std::vector<any<Tags...>> {
+  using any_type = any<Tags...>;
+  using value_type = std::iter_value_t<Iterator>;
+  using model = typename detail::any_interface_t<
+      detail::get_options<any_type>>::template model<value_type>;
+  using storage = std::remove_reference_t<decltype(detail::buffer_ref(
+      std::declval<any_type &>()))>;
+
+  std::vector<any_type> result;
+  auto const n = static_cast<std::size_t>(std::distance(first, last));
+  result.reserve(n);
+  if constexpr (!storage::template spills<model>) {
+    for (; first != last; ++first) {
+      result.emplace_back(*first);
+    }
+  } else {
+    constexpr ubuf::buffer_spec spec{sizeof(model), alignof(model)};
+    static_assert(spec.align <= alignof(std::max_align_t),
+                  "Over-aligned values can't be placed in bulk.");
+    if (n == 0) {
+      return result;
+    }
+    detail::bulk_fill fill(detail::bulk_bytes(spec, n));
+    for (; first != last; ++first) {
+      auto &x = result.emplace_back();
+      auto const slot = fill.next(spec);
+      detail::make_model<model>(slot, *first);
+      fill.adopt(x, slot);
+    }
+  }
+  return result;
+}
+
+/**
+ * Appends copies of the anys in src to dst. Models that spill in src share
+ * one allocation in dst.
+ */
+template <typename Range, typename AnyOptions>
+void clone_range(Range const &src, std::vector<any_t<AnyOptions>> &dst) {
+  using concept_type = detail::concept_t<AnyOptions>;
+  auto const spilled = [](auto const &x) {
+    auto const &buf = detail::buffer_ref(x);
+    return buf && !buf.is_internal();
+  };
+
+  std::size_t bytes = 0;
+  std::size_t n = 0;
+  detail::spec_cache<concept_type> spec_of;
+  for (auto const &x : src) {
+    ++n;
+    if (spilled(x)) {
+      auto const spec = spec_of(*concept_ptr(x));
+      assert(spec.align <= alignof(std::max_align_t));
+      bytes = ubuf::bulk_block::slot(bytes, spec).second;
+    }
+  }
+  dst.reserve(dst.size() + n);
+  if (bytes == 0) {
+    dst.insert(dst.end(), std::begin(src), std::end(src));
+    return;
+  }
+
+  detail::bulk_fill fill(bytes);
+  for (auto const &x : src) {
+    if (!spilled(x)) {
+      dst.push_back(x);
+      continue;
+    }
+    auto &y = dst.emplace_back();
+    auto const &model = *concept_ptr(x);
+    auto const spec = spec_of(model);
+    auto const slot = fill.next(spec);
+    if (spec.trivially_copyable) {
+      // the vtable pointer is copied along with the value
+      std::memcpy(slot.data, &model, spec.size);
+    } else {
+#ifdef ERASURE_HOOKS
+      hooks::notify_dispatched<tag_t<detail::copy_construct_in>>();
+#endif
+      model.erase(tag<detail::copy_construct_in>, slot);
+    }
+    fill.adopt(y, slot);
+  }
+}
+
+} // namespace erasure
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file demangle.hpp
+ * The name of a type from its std::type_info, for messages.
+ *
+ * Names are demangled with the C++ ABI library where there is one, and used
+ * as given (e.g. already demangled by MSVC) otherwise. Where the type is
+ * known at compile time, erasure::type_name<T>() needs neither.
+ */
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace erasure {
+namespace detail {
+/** The demangled form of name, a std::type_info::name(). */
+inline auto demangle(char const *name) -> std::string {
+#if __has_include(<cxxabi.h>)
+  int status = 0;
+  std::unique_ptr<char, void (*)(void *)> const demangled{
+      abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free};
+  if (status == 0) {
+    return demangled.get();
+  }
+#endif
+  return name;
+}
+} // namespace detail
+} // namespace erasure
@@ -212,11 +212,19 @@
 
 // for the storage
 #include "small_buffer.hpp"
+// for the identity of value types
+#include "type_hash.hpp"
+
+#ifdef ERASURE_ENABLE_PROFILING
+#include "profiling.hpp"
+#endif
+
 // for all options interpretation
 #include "meta.hpp"
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <new> // for placement new
 #include <type_traits>
 #include <typeindex>
@@ -249,6 +257,29 @@ auto same_dynamic_type(Pointer1 const &x, Pointer2 const &y) -> bool {
   // works.
   return x && y && (std::type_index(typeid(*x)) == std::type_index(typeid(*y)));
 }
+
+/**
+ * The value of a model, and the typeid and type_hash of its type. type_hash is
+ * 0 for types without one.
+ */
+struct erased_value {
+  std::type_info const *type;
+  std::uint64_t type_hash;
+  void const *value;
+};
+
+namespace detail {
+/**
+ * If v is of the type with these typeid and type_hash. typeid decides, unless
+ * the type_infos differ, as those of one type from two shared objects may;
+ * then the type hashes do, for types that have them.
+ */
+inline auto is_type(erased_value const &v, std::type_info const &type,
+                    std::uint64_t type_hash) -> bool {
+  return *v.type == type || (v.type_hash != 0 && v.type_hash == type_hash);
+}
+} // namespace detail
+
 template <typename AnyOptions>
 struct any_t;
 template <typename Interface>
@@ -347,6 +378,7 @@ using feature_concept_check_t = typename feature_concept_check<T>::type;
 namespace detail {
 struct sizeof_alignof;
 struct target_type;
+struct value_identity;
 struct allocate;
 struct copy_construct_in;
 struct allocate_and_copy_construct_in;
@@ -366,7 +398,8 @@ struct concept_traits<concept_base<Concept, AnyOptions>> {
   using const_pointer = concept_type const *;
   using options = AnyOptions;
   using storage_type =
-      ubuf::small_buffer<(typename options::buffer_actual_size){}>;
+      ubuf::small_buffer<(typename options::buffer_actual_size){},
+                         (typename options::packed){}>;
 };
 
 template <typename Concept, typename AnyOptions>
@@ -375,6 +408,7 @@ struct concept_base {
   virtual auto erase(tag_t<sizeof_alignof>) const -> ubuf::buffer_spec = 0;
   // type support
   virtual auto erase(tag_t<target_type>) const -> std::type_info const & = 0;
+  virtual auto erase(tag_t<value_identity>) const -> erased_value = 0;
   /**
    * @param buf inout.
    */
@@ -521,11 +555,16 @@ struct model_base : Concept {
 
   // dynamic queries
   auto erase(tag_t<sizeof_alignof>) const -> ubuf::buffer_spec final {
-    return {sizeof(m_model<model_base>), alignof(m_model<model_base>)};
+    return {sizeof(m_model<model_base>), alignof(m_model<model_base>),
+            std::is_trivially_copyable_v<m_value<model_base>>};
   }
   auto erase(tag_t<target_type>) const -> std::type_info const & final {
     return typeid(m_value<model_base>);
   }
+  auto erase(tag_t<value_identity>) const -> erased_value final {
+    return {&typeid(m_value<model_base>),
+            checked_type_hash<m_value<model_base>>(), &erasure::value(*this)};
+  }
   auto erase(tag_t<allocate>, m_storage<Concept> &buf) const
       -> ubuf::buffer_t final {
     return buf.template allocate<m_model<model_base>>();
@@ -558,6 +597,12 @@ struct reference_type<std::reference_wrapper<Value>> {
   using const_reference = type const &;
 };
 
+/** Selects the constructors that take the value from a call of a function. */
+struct from_call_t {
+  explicit from_call_t() = default;
+};
+inline constexpr from_call_t from_call{};
+
 /* ******************************************************************
  * type function: model
  * ******************************************************************/
@@ -568,15 +613,43 @@ struct model_t : chain_models<Value, model_t<Value, Concept>, Concept> {
   static_assert(std::is_same<m_value<model_t>, Value>(),
                 "chain_models bug: incorrect chaining of value_type.");
 
-  model_t() {}
-  model_t(Value &&x) : _value(std::move(x)) {}
-  model_t(Value const &x) : _value(x) {}
+  // constrained, so that an explicit instantiation only gets what Value has
+  model_t()
+    requires std::is_default_constructible_v<Value>
+  {}
+  model_t(Value &&x)
+    requires std::is_move_constructible_v<Value>
+      : _value(std::move(x)) {}
+  model_t(Value const &x)
+    requires std::is_copy_constructible_v<Value>
+      : _value(x) {}
+  /** Initializes the value with what f() returns, without a move from it. */
+  template <typename F>
+  model_t(from_call_t, F &&f) : _value(std::forward<F>(f)()) {}
+
+  /**
+   * With pack_scalars, the buffer releases such models without calling their
+   * destructor, which does nothing for a trivially destructible value.
+   */
+  static constexpr bool packable = std::is_trivially_destructible_v<Value>;
 
   Value _value;
 };
 
 template <typename Value, typename Concept>
 using any_model = model_t<Value, Concept>;
+} // namespace detail
+
+#ifdef ERASURE_SPILL_TELEMETRY
+template <typename Value, typename AnyOptions>
+struct telemetry::model_identity<
+    detail::model_t<Value, detail::concept_t<AnyOptions>>> {
+  using any_type = any_t<AnyOptions>;
+  using value_type = Value;
+};
+#endif
+
+namespace detail {
 
 /* ******************************************************************
  * type function: chain_interfaces
@@ -589,7 +662,14 @@ using link_importers = typename Tag::template importer<Base1, Base2>;
 
 // base of recursion
 template <typename InterfaceTraits>
-struct interface_base {};
+struct interface_base {
+  /**
+   * Features that cache something about the value in the handle hide this
+   * with a version that calls the one they hide and then refreshes their
+   * cache. It is called after every construction, assignment and swap.
+   */
+  void _any_refresh_caches() {}
+};
 
 template <typename InterfaceTraits>
 constexpr auto interface_support_type(interface_base<InterfaceTraits> const &)
@@ -682,11 +762,30 @@ template <typename Interface>
 void reset(Interface &x);
 template <typename Interface>
 auto buffer_ref(Interface &&x) -> decltype(auto);
+
+template <typename Any>
+void refresh_caches(Any &x) {
+  x._any_refresh_caches();
+}
 } // namespace detail
 
 template <typename Tag, typename Interface, typename... As>
 [[gnu::always_inline]] inline auto call(Interface &&x, As &&... as)
     -> decltype(auto) {
+#ifdef ERASURE_HOOKS
+  hooks::notify_dispatched<tag_t<Tag>>();
+#endif
+#ifdef ERASURE_ENABLE_PROFILING
+  if constexpr (requires {
+                  ifc_concept_ptr(x)->erase(tag<profiling::probe<Tag>>);
+                }) {
+    return profiling::detail::probed(
+        ifc_concept_ptr(x)->erase(tag<profiling::probe<Tag>>),
+        [&]() -> decltype(auto) {
+          return ifc_concept_ptr(x)->erase(tag<Tag>, (As &&) as...);
+        });
+  }
+#endif
   return ifc_concept_ptr(x)->erase(tag<Tag>, (As &&) as...);
 }
 namespace detail {
@@ -703,12 +802,21 @@ struct creation_support : S::base {
   creation_support(T &&value) {
     auto &any_this = static_cast<typename S::any_type &>(*this);
     create_any_from_value(any_this, std::forward<T>(value));
+    refresh_caches(any_this);
+  }
+  /** Lets fill construct the value of the empty any. */
+  template <typename Fill>
+  creation_support(from_call_t, Fill &&fill) {
+    auto &any_this = static_cast<typename S::any_type &>(*this);
+    std::forward<Fill>(fill)(any_this);
+    refresh_caches(any_this);
   }
   template <typename T, typename = disable_if_same_any_type<S, T>>
   auto operator=(T &&value) -> typename S::any_type & {
     auto &any_this = static_cast<typename S::any_type &>(*this);
     reset(any_this);
     create_any_from_value(any_this, std::forward<T>(value));
+    refresh_caches(any_this);
     return any_this;
   }
   ~creation_support() { reset(self_any_cast<S>(*this)); }
@@ -718,6 +826,9 @@ private:
   typename S::storage _any_ifc_value;
 };
 
+template <typename AO>
+auto same_vtable(any_t<AO> const &x, any_t<AO> const &y) -> bool;
+
 // MOVE IMPLEMENTATIONS
 template <typename AO>
 auto move_construct_any(any_t<AO> &target, any_t<AO> &&source) -> any_t<AO> & {
@@ -736,7 +847,7 @@ auto move_assign_any(any_t<AO> &target, any_t<AO> &&source,
 template <typename AO>
 auto move_assign_any(any_t<AO> &target, any_t<AO> &&source,
                      /* is_move_assignable */ std::true_type) -> any_t<AO> & {
-  if (same_dynamic_type(target, source)) {
+  if (same_vtable(target, source)) {
     erasure::call<move_assignable>(target,
                                    std::move(*erasure::concept_ptr(source)));
   } else {
@@ -763,7 +874,7 @@ auto copy_assign_any(Any1 &target, Any2 const &source, std::false_type)
 template <typename Any1, typename Any2>
 auto copy_assign_any(Any1 &target, Any2 const &source, std::true_type)
     -> Any1 & {
-  if (same_dynamic_type(target, source)) {
+  if (same_vtable(target, source)) {
     erasure::call<copy_assignable>(target, *erasure::concept_ptr(source));
   } else {
     copy_assign_any(target, source, std::false_type{});
@@ -777,27 +888,34 @@ auto copy_assign_any(Any1 &target, Any2 const &source, std::true_type)
   interface_t(interface_t &&x) {                                               \
     move_construct_any(self_any_cast<S>(*this),                                \
                        std::move(self_any_cast<S>(x)));                        \
+    refresh_caches(self_any_cast<S>(*this));                                   \
+    refresh_caches(self_any_cast<S>(x));                                       \
   }                                                                            \
   static_assert(true, "")
 
 #define INTERFACE_T_COPY_CONSTRUCTOR                                           \
   interface_t(interface_t const &x) {                                          \
     copy_construct_any(self_any_cast<S>(*this), self_any_cast<S>(x));          \
+    refresh_caches(self_any_cast<S>(*this));                                   \
   }                                                                            \
   static_assert(true, "")
 
 #define INTERFACE_T_MOVE_ASSIGNMENT                                            \
   interface_t &operator=(interface_t &&x) {                                    \
-    return move_assign_any(self_any_cast<S>(*this),                            \
-                           std::move(self_any_cast<S>(x)),                     \
-                           typename S::is_move_assignable{});                  \
+    move_assign_any(self_any_cast<S>(*this), std::move(self_any_cast<S>(x)),   \
+                    typename S::is_move_assignable{});                         \
+    refresh_caches(self_any_cast<S>(*this));                                   \
+    refresh_caches(self_any_cast<S>(x));                                       \
+    return *this;                                                              \
   }                                                                            \
   static_assert(true, "")
 
 #define INTERFACE_T_COPY_ASSIGNMENT                                            \
   interface_t &operator=(interface_t const &x) {                               \
-    return copy_assign_any(self_any_cast<S>(*this), self_any_cast<S>(x),       \
-                           typename S::is_copy_assignable{});                  \
+    copy_assign_any(self_any_cast<S>(*this), self_any_cast<S>(x),              \
+                    typename S::is_copy_assignable{});                         \
+    refresh_caches(self_any_cast<S>(*this));                                   \
+    return *this;                                                              \
   }                                                                            \
   static_assert(true, "")
 
@@ -1012,16 +1130,56 @@ template <typename Interface>
 void reset(Interface &x) {
   using vtbl = ifc_concept<Interface>;
   auto value = erasure::concept_ptr(x);
-  if (value) {
+  if (buffer_ref(x).is_packed()) {
+    buffer_ref(x).reset();
+  } else if (value) {
+#ifdef ERASURE_HOOKS
+    hooks::notify_dispatched<tag_t<hooks::destruction>>();
+#endif
     value->~vtbl();
     buffer_ref(x).reset();
   }
 }
 } // namespace detail
 
+namespace detail {
+/** The first word of a model, which is its vtable pointer. */
+inline auto vtable_word(void const *model) -> void const * {
+  void const *word;
+  std::memcpy(&word, model, sizeof(word));
+  return word;
+}
+} // namespace detail
+
+namespace detail {
+/**
+ * If x and y have the same vtable, and so the same value type. Assignment and
+ * swap use it to pick their fast path; the same type made in another shared
+ * object just takes the general one.
+ */
+template <typename AO>
+auto same_vtable(any_t<AO> const &x, any_t<AO> const &y) -> bool {
+  auto const &bx = buffer_ref(x);
+  auto const &by = buffer_ref(y);
+  return bx && by && vtable_word(bx.get()) == vtable_word(by.get());
+}
+} // namespace detail
+
+/**
+ * The same vtable means the same value type. Different ones may still be the
+ * same type, made in another shared object; see detail::is_type.
+ */
 template <typename AO>
 auto same_dynamic_type(any_t<AO> const &x, any_t<AO> const &y) -> bool {
-  return same_dynamic_type(erasure::concept_ptr(x), erasure::concept_ptr(y));
+  if (empty(x) || empty(y)) {
+    return false;
+  }
+  if (detail::same_vtable(x, y)) {
+    return true;
+  }
+  auto const vy = erasure::call<detail::value_identity>(y);
+  return detail::is_type(erasure::call<detail::value_identity>(x), *vy.type,
+                         vy.type_hash);
 }
 
 namespace detail {
@@ -1075,10 +1233,26 @@ template <typename T>
 struct is_buffer_size : std::false_type {};
 template <std::size_t BufferSize>
 struct is_buffer_size<buffer_size<BufferSize>> : std::true_type {};
+} // namespace detail
+
+/**
+ * The option to mark trivially destructible values that fit the small buffer,
+ * so that destroying them is no call through the vtable. It does not change
+ * the size of the handle.
+ */
+struct pack_scalars {};
+namespace detail {
+template <>
+struct feature_concept_check<pack_scalars> {
+  using type = std::true_type;
+};
+/** The predicate that tells us whether a tag is an option, not a feature */
+template <typename T>
+struct is_option : std::bool_constant<is_buffer_size<T>{} ||
+                                      std::is_same_v<T, pack_scalars>> {};
 
 using meta::head_t;
 
-using meta::and_;
 using meta::concatenate_t;
 using meta::copy_if_not_t;
 using meta::find_first_t;
@@ -1090,34 +1264,38 @@ struct any_options {
   using all_tags = Taglist;
   using all_tags_default_size =
       concatenate_t<all_tags, typelist<buffer_size<0>>>;
-  using tags = copy_if_not_t<is_buffer_size, all_tags>;
+  using tags = copy_if_not_t<is_option, all_tags>;
+  using packed = meta::is_element_t<pack_scalars, all_tags>;
   using buffer_actual_size =
       find_first_t<is_buffer_size, all_tags_default_size>;
 
-  template <typename F1, typename F2>
-  using equal_provides =
-      meta::is_same_t<typename F1::provides, typename F2::provides>;
+  template <typename F>
+  using provides = typename F::provides;
 
   using feature_groups =
-      map_t<feature_group, meta::group_by_t<equal_provides, tags>>;
+      map_t<feature_group, meta::group_by_key_t<provides, tags>>;
 };
 
 /**
- * Should be the same as is_same, except compare buffer_size features without
- * regard for their parameter.
+ * The key tags are deduplicated by: the tag itself, except that all
+ * buffer_size features share one key regardless of their parameter.
  */
-template <typename T, typename U>
-using tag_equivalence =
-    std::conditional_t<std::is_same<T, U>{}, std::true_type,
-                       and_<is_buffer_size<T>, is_buffer_size<U>>>;
+template <typename T>
+using tag_key = std::conditional_t<is_buffer_size<T>{}, buffer_size<0>, T>;
 /**
  * Flatten the options list and deduplicate tags. Take the earliest of any tag
  * encountered and forget all subsequent ones. Treat buffer_size parameters as
  * equivalent and only take the first one.
+ *
+ * The remaining tags are sorted by name, so that every spelling of the same
+ * feature set makes the same any type. The order, and so the vtable layout,
+ * is the same across shared objects built by one compiler; features that
+ * need it to be the same across compilers declare a sort_key (see
+ * meta::sort_name).
  */
 template <typename Typelist>
-using make_options =
-    any_options<meta::unique_t<meta::flatten_t<Typelist>, tag_equivalence>>;
+using make_options = any_options<meta::sort_by_name_t<
+    meta::unique_by_t<meta::flatten_t<Typelist>, tag_key>>>;
 template <typename... Tags>
 using options = make_options<typelist<Tags...>>;
 
@@ -1215,17 +1393,39 @@ void create_any_from_value(any_t<AnyOptions> &x, T &&value) {
   make_model<model>(buffer_ref(x).template allocate<model>(),
                     std::forward<T>(value));
 }
+/**
+ * Makes what f() returns the value of the empty x. The value is constructed
+ * straight into the model, in x's buffer or on the heap.
+ */
+template <typename AnyOptions, typename F>
+void create_any_from_call(any_t<AnyOptions> &x, F &&f) {
+  assert(empty(x));
+  using model = ifc_model<decltype(x), std::decay_t<std::invoke_result_t<F>>>;
+  auto const storage = buffer_ref(x).template allocate<model>();
+  try {
+    new (storage.data) model(from_call, std::forward<F>(f));
+  } catch (...) {
+    buffer_ref(x).reset();
+    throw;
+  }
+}
 } // namespace detail
 template <typename... Tags, typename T>
 auto make_any(T &&x) -> any<Tags...> {
   return {std::forward<T>(x)};
 }
 
+/** The value of x if it is a T, also if x was made in another DSO. */
 template <typename T, typename AnyOptions>
 auto target(any_t<AnyOptions> const &x) -> T const * {
-  using cast_to = detail::ifc_model<decltype(x), T>;
-  auto const impl_p = dynamic_cast<cast_to const *>(concept_ptr(x));
-  return impl_p ? &erasure::value(*impl_p) : nullptr;
+  if (empty(x)) {
+    return nullptr;
+  }
+  using U = std::remove_cv_t<T>;
+  auto const v = erasure::call<detail::value_identity>(x);
+  return detail::is_type(v, typeid(U), detail::checked_type_hash<U>())
+             ? static_cast<T const *>(v.value)
+             : nullptr;
 }
 template <typename T, typename AnyOptions>
 auto target(any_t<AnyOptions> &x) -> T * {
@@ -1260,6 +1460,9 @@ struct feature {
  * MOVE_CONSTRUCTIBLE
  * ***********************************************************/
 struct move_constructible : feature {
+  // see layout.hpp
+  static constexpr std::size_t vtable_slots = 2;
+
   template <typename C>
   struct vtbl : C {
     using C::erase;
@@ -1313,6 +1516,9 @@ struct move_assignable : feature {
  * COPYABLE
  * ***********************************************************/
 struct copy_constructible : feature {
+  // see layout.hpp
+  static constexpr std::size_t vtable_slots = 2;
+
   template <typename C>
   struct vtbl : C {
     using C::erase;
@@ -1363,6 +1569,57 @@ struct copy_assignable : feature {
   using interface = I;
 };
 
+namespace detail {
+/**
+ * Moves the model in from into the empty to, and destroys it in from. Does
+ * not allocate when to is a buffer of the same size, unless the model is
+ * aligned beyond a pointer and does not fit at to's alignment.
+ */
+template <typename Concept, typename Storage>
+void relocate_model(Storage &from, Storage &to) {
+  if (!from) {
+    return;
+  }
+  auto const model = static_cast<Concept *>(from.get());
+#ifdef ERASURE_HOOKS
+  hooks::notify_dispatched<tag_t<allocate_and_move_construct_in>>();
+#endif
+  model->erase(tag<allocate_and_move_construct_in>, to);
+#ifdef ERASURE_HOOKS
+  hooks::notify_dispatched<tag_t<hooks::destruction>>();
+#endif
+  model->~Concept();
+  from.reset();
+}
+
+/**
+ * Swaps the models in two buffers of one any type, by handing over heap
+ * pointers and relocating inline models, through a temporary buffer on the
+ * stack when both are inline. Allocates only for the models relocate_model
+ * would.
+ */
+template <typename Concept, typename Storage>
+void swap_storage(Storage &x, Storage &y) {
+  if (swap_if_not_internal(x, y)) {
+    return;
+  }
+  if (!x || !x.is_internal()) {
+    auto const heap_model = x.release();
+    relocate_model<Concept>(y, x);
+    y.adopt(heap_model);
+  } else if (!y || !y.is_internal()) {
+    auto const heap_model = y.release();
+    relocate_model<Concept>(x, y);
+    x.adopt(heap_model);
+  } else {
+    Storage tmp;
+    relocate_model<Concept>(x, tmp);
+    relocate_model<Concept>(y, x);
+    relocate_model<Concept>(tmp, y);
+  }
+}
+} // namespace detail
+
 /* ***************************************************************
  * SWAPPABLE
  * ***************************************************************/
@@ -1386,16 +1643,14 @@ struct swappable : feature {
   template <typename I>
   struct interface : I {
     friend void swap(erasure::ifc<I> &x, erasure::ifc<I> &y) noexcept {
-      if (same_dynamic_type(x, y)) {
+      if (detail::same_vtable(x, y)) {
         erasure::call<swappable>(x, *erasure::concept_ptr(y));
       } else {
-        // just swap the pointers
-        if (!swap_if_not_internal(buffer_ref(x), buffer_ref(y))) {
-          // if not swapped we need to go the slow way, using moves. Use
-          // std::swap explicitly to not recurse into this function.
-          std::swap(x, y);
-        }
+        detail::swap_storage<detail::ifc_concept<decltype(x)>>(buffer_ref(x),
+                                                               buffer_ref(y));
       }
+      detail::refresh_caches(x);
+      detail::refresh_caches(y);
     }
   };
 };
@@ -1442,6 +1697,7 @@ using meta::typelist;
 namespace features {
 // type tags implementation
 using erasure::buffer_size;
+using erasure::pack_scalars;
 using erasure::copy_assignable;
 using erasure::copy_constructible;
 using erasure::move_assignable;
@@ -15,8 +15,21 @@
  */
 
 #pragma once
+/**
+ * @file callable.hpp
+ * callable<Signature>: an any that can be called like a function.
+ *
+ * When the signature returns an any type, the vtable takes the caller's
+ * result instead of returning one: the model constructs what the function
+ * returns straight into the result's buffer, and the result is the return
+ * value of the call operator. Returning small values of any type then costs
+ * no allocation and no move of the value.
+ */
 #include "erasure/erasure.hpp"
 
+#include <type_traits>
+#include <utility>
+
 namespace erasure {
 namespace features {
 namespace callable_detail {
@@ -29,6 +42,30 @@ struct provides_call_operator {
   };
 };
 
+template <typename Return>
+concept returns_any = erasure::detail::is_any<Return>::value;
+
+/**
+ * Makes what f() returns the value of the empty result. An any of result's
+ * type is moved or copied into it, never assigned, so that results that are
+ * only move constructible work.
+ */
+template <typename Any, typename F>
+void emplace_result(Any &result, F &&f) {
+  using returned = std::invoke_result_t<F>;
+  if constexpr (std::is_same_v<std::remove_cvref_t<returned>, Any>) {
+    auto &&value = std::forward<F>(f)();
+    if constexpr (std::is_lvalue_reference_v<returned>) {
+      erasure::detail::copy_construct_any(result, value);
+    } else {
+      erasure::detail::move_construct_any(result, std::move(value));
+      erasure::detail::refresh_caches(value);
+    }
+  } else {
+    erasure::detail::create_any_from_call(result, std::forward<F>(f));
+  }
+}
+
 } // namespace callable_detail
 
 // provide the correct form for pattern matching
@@ -37,6 +74,7 @@ struct callable;
 
 #define ERASURE_CALLABLE_DEF(constness)                                        \
   template <typename Return, typename... Args>                                 \
+    requires(!callable_detail::returns_any<Return>)                            \
   struct callable<Return(Args...) constness> : feature_support::feature {      \
     using provides = callable_detail::provides_call_operator;                  \
                                                                                \
@@ -63,6 +101,39 @@ struct callable;
         return erasure::call<callable>(*this, (Args)args...);                  \
       }                                                                        \
     };                                                                         \
+  };                                                                           \
+                                                                               \
+  template <typename Return, typename... Args>                                 \
+    requires callable_detail::returns_any<Return>                              \
+  struct callable<Return(Args...) constness> : feature_support::feature {      \
+    using provides = callable_detail::provides_call_operator;                  \
+                                                                               \
+    template <typename C>                                                      \
+    struct vtbl : C {                                                          \
+      using C::erase;                                                          \
+      virtual void erase(erasure::tag_t<callable>, Return &result,             \
+                         Args... args) constness = 0;                          \
+    };                                                                         \
+                                                                               \
+    template <typename M>                                                      \
+    struct model : M {                                                         \
+      using M::erase;                                                          \
+      void erase(erasure::tag_t<callable>, Return &result,                     \
+                 Args... args) constness final {                               \
+        callable_detail::emplace_result(result, [&]() -> decltype(auto) {      \
+          return erasure::value(std::forward<M constness>(*this))(args...);    \
+        });                                                                    \
+      }                                                                        \
+    };                                                                         \
+                                                                               \
+    template <typename I>                                                      \
+    struct interface : I {                                                     \
+      auto operator()(Args... args) constness -> Return {                      \
+        return Return(erasure::detail::from_call, [&](Return &result) {        \
+          erasure::call<callable>(*this, result, (Args)args...);               \
+        });                                                                    \
+      }                                                                        \
+    };                                                                         \
   }
 
 ERASURE_CALLABLE_DEF();
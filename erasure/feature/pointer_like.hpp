@@ -0,0 +1,90 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file pointer_like.hpp
+ * pointer_like<T>: an any over pointers to T (raw, smart or fancy) that
+ * dereferences without a virtual call.
+ *
+ * The handle keeps the address of the held pointer, which is refreshed
+ * through the vtable after every construction, assignment and swap of the
+ * any, the only ways to move the model. `*p`, `p->` and `p.get()` read the
+ * held pointer through it - with one load for a T *, and a call through a
+ * function pointer to std::to_address for smart and fancy pointers - so
+ * they see it changed in place too, through target<T>(), erasure::value()
+ * or another feature. Like a smart pointer, a const any gives a mutable T.
+ */
+
+#include "erasure/erasure.hpp"
+
+#include <memory>
+#include <type_traits>
+
+namespace erasure {
+namespace features {
+template <typename T>
+struct pointer_like : feature_support::feature {
+  /** Where the held pointer is, and how to read it if it isn't a T *. */
+  struct held_pointer {
+    void const *address;
+    T *(*load)(void const *address);
+  };
+
+  template <typename C>
+  struct vtbl : C {
+    using C::erase;
+    virtual auto erase(erasure::tag_t<pointer_like>) -> held_pointer = 0;
+  };
+  template <typename M>
+  struct model : M {
+    using M::erase;
+    auto erase(erasure::tag_t<pointer_like>) -> held_pointer final {
+      auto const &p = erasure::value(*this);
+      using pointer = std::remove_cvref_t<decltype(p)>;
+      if constexpr (std::is_same_v<pointer, T *>) {
+        return {&p, nullptr};
+      } else {
+        return {&p, [](void const *address) -> T * {
+                  return std::to_address(
+                      *static_cast<pointer const *>(address));
+                }};
+      }
+    }
+  };
+  template <typename I>
+  struct interface : I {
+    auto get() const noexcept -> T * {
+      return _held.load ? _held.load(_held.address)
+                        : *static_cast<T *const *>(_held.address);
+    }
+    auto operator*() const noexcept -> T & { return *get(); }
+    auto operator->() const noexcept -> T * { return get(); }
+
+    void _any_refresh_caches() {
+      I::_any_refresh_caches();
+      _held = erasure::detail::ifc_concept_ptr(*this)
+                  ? erasure::call<pointer_like>(*this)
+                  : held_pointer{&_null, nullptr};
+    }
+
+  private:
+    static constexpr T *_null = nullptr;
+    held_pointer _held{&_null, nullptr};
+  };
+};
+} // namespace features
+} // namespace erasure
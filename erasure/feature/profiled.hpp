@@ -0,0 +1,96 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "erasure/erasure.hpp"
+
+/**
+ * @file profiled.hpp
+ * `profiled<F>` counts the calls that F dispatches through `erasure::call<F>`
+ * per dynamic value type, and times a sample of them. Use it in place of F:
+ *
+ *     using handler = any<profiled<function<void(event const &)>>, ...>;
+ *
+ * Feature sets are profiled feature by feature; copy and move construction
+ * are not calls and are not counted. Results are read with
+ * `erasure::profiling::snapshot()`; `dbg_util::print_profile` prints them.
+ *
+ * Without ERASURE_ENABLE_PROFILING, `profiled<F>` is F.
+ */
+
+namespace erasure {
+#ifdef ERASURE_ENABLE_PROFILING
+namespace profiling {
+template <typename Feature>
+struct probe : feature_support::feature {
+  template <typename C>
+  struct vtbl : C {
+    using C::erase;
+    virtual auto erase(tag_t<probe>) const -> counters & = 0;
+  };
+
+  template <typename M>
+  struct model : M {
+    using M::erase;
+    auto erase(tag_t<probe>) const -> counters & final {
+      return detail::thread_counters<Feature, erasure::detail::m_value<M>>();
+    }
+  };
+
+  template <typename I>
+  using interface = I;
+};
+
+namespace detail {
+template <typename Feature>
+struct profiled {
+  using type = meta::typelist<Feature, probe<Feature>>;
+};
+// not features of their own, or not dispatched with call<F>
+template <std::size_t Size>
+struct profiled<buffer_size<Size>> {
+  using type = buffer_size<Size>;
+};
+template <>
+struct profiled<pack_scalars> {
+  using type = pack_scalars;
+};
+template <>
+struct profiled<copy_constructible> {
+  using type = copy_constructible;
+};
+template <>
+struct profiled<move_constructible> {
+  using type = move_constructible;
+};
+template <typename... Features>
+struct profiled<meta::typelist<Features...>> {
+  using type = meta::typelist<typename profiled<Features>::type...>;
+};
+} // namespace detail
+} // namespace profiling
+#endif
+
+namespace features {
+#ifdef ERASURE_ENABLE_PROFILING
+template <typename Feature>
+using profiled = typename profiling::detail::profiled<Feature>::type;
+#else
+template <typename Feature>
+using profiled = Feature;
+#endif
+} // namespace features
+} // namespace erasure
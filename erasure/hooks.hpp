@@ -0,0 +1,126 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file hooks.hpp
+ * Observation points in the storage and dispatch paths.
+ *
+ * The notifications are only compiled in when ERASURE_HOOKS is defined, and
+ * then cost one atomic load each while no observer is registered. Define it
+ * for the whole program (not per translation unit), or the any types of
+ * different translation units will disagree on their definitions.
+ *
+ * Observers form an intrusive list. Adding and removing them is serialised,
+ * but not with the notifications themselves: register observers before the
+ * anys they should observe are used concurrently, and do not remove an
+ * observer while another thread may be notifying it.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <typeinfo>
+
+namespace erasure {
+namespace hooks {
+
+/** The tag dispatches to a model's (virtual) destructor are reported with. */
+struct destruction {};
+
+/** A model was placed into an any's storage. */
+struct placement {
+  std::type_info const &model_type;
+  std::size_t size;
+  std::size_t align;
+  /** The size of the small buffer it was offered. */
+  std::size_t capacity;
+  bool on_heap;
+};
+
+struct observer {
+  observer() = default;
+  observer(observer const &) = delete;
+  auto operator=(observer const &) -> observer & = delete;
+  virtual ~observer() = default;
+
+  virtual void placed(placement const &) {}
+  /** A heap-placed model's memory was given back. */
+  virtual void deallocated(void const *) {}
+  /** A call was dispatched through the model's vtable, as tag_t<Feature>. */
+  virtual void dispatched(std::type_info const & /* tag */) {}
+
+private:
+  friend void add_observer(observer &);
+  friend void remove_observer(observer &);
+  template <typename F>
+  friend void notify(F &&);
+  observer *next = nullptr;
+};
+
+namespace detail {
+template <typename = void>
+std::atomic<observer *> head{nullptr};
+template <typename = void>
+std::mutex registration;
+} // namespace detail
+
+inline void add_observer(observer &x) {
+  std::lock_guard<std::mutex> lock(detail::registration<>);
+  x.next = detail::head<>.load();
+  detail::head<>.store(&x);
+}
+
+inline void remove_observer(observer &x) {
+  std::lock_guard<std::mutex> lock(detail::registration<>);
+  observer *prev = nullptr;
+  for (auto p = detail::head<>.load(); p; prev = p, p = p->next) {
+    if (p == &x) {
+      if (prev) {
+        prev->next = p->next;
+      } else {
+        detail::head<>.store(p->next);
+      }
+      return;
+    }
+  }
+}
+
+/** Calls f(observer &) on every registered observer. */
+template <typename F>
+void notify(F &&f) {
+  for (auto p = detail::head<>.load(std::memory_order_acquire); p;
+       p = p->next) {
+    f(*p);
+  }
+}
+
+template <typename Model>
+void notify_placed(std::size_t capacity, bool on_heap) {
+  notify([&](observer &o) {
+    o.placed({typeid(Model), sizeof(Model), alignof(Model), capacity, on_heap});
+  });
+}
+inline void notify_deallocated(void const *addr) {
+  notify([&](observer &o) { o.deallocated(addr); });
+}
+template <typename Tag>
+void notify_dispatched() {
+  notify([&](observer &o) { o.dispatched(typeid(Tag)); });
+}
+
+} // namespace hooks
+} // namespace erasure
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file instantiation.hpp
+ * Explicit instantiation of any types and their models.
+ *
+ * Every translation unit that uses an any type emits its vtable, its models'
+ * vtables and all the functions behind them, and the linker throws all but
+ * one copy away. To build them once, declare them extern in a header:
+ *
+ *     using shape = erasure::any<regular, ostreamable>;
+ *     ERASURE_EXTERN_ANY(shape);
+ *     ERASURE_EXTERN_MODEL(shape, circle);
+ *
+ * and define them in exactly one translation unit:
+ *
+ *     ERASURE_INSTANTIATE_ANY(shape);
+ *     ERASURE_INSTANTIATE_MODEL(shape, circle);
+ *
+ * The macros must be used at global scope. ERASURE_EXTERN_ANY and
+ * ERASURE_INSTANTIATE_ANY take the any type, commas and all; the model macros
+ * take two arguments, so spell an any type with several features through an
+ * alias there.
+ *
+ * The compiler still instantiates the class templates it needs in every
+ * translation unit, and may still inline their functions; what it stops
+ * emitting are the vtables and the out-of-line copies of the functions.
+ */
+
+#include "erasure.hpp"
+
+namespace erasure {
+namespace detail {
+template <typename Any>
+using any_support =
+    typename any_interface_t<get_options<Any>>::support_type;
+template <typename Any>
+using any_vtbl = concept_t<get_options<Any>>;
+} // namespace detail
+} // namespace erasure
+
+#define ERASURE_DETAIL_ANY_INSTANTIATION(EXTERN, ...)                          \
+  EXTERN template struct ::erasure::detail::concept_t<                         \
+      ::erasure::detail::get_options<__VA_ARGS__>>;                            \
+  EXTERN template struct ::erasure::detail::creation_support<                  \
+      ::erasure::detail::any_support<__VA_ARGS__>>;                            \
+  EXTERN template struct ::erasure::detail::interface_t<                       \
+      ::erasure::detail::any_support<__VA_ARGS__>::is_move_constructible{},    \
+      ::erasure::detail::any_support<__VA_ARGS__>::is_move_assignable{},       \
+      ::erasure::detail::any_support<__VA_ARGS__>::is_copy_constructible{},    \
+      ::erasure::detail::any_support<__VA_ARGS__>::is_copy_assignable{},       \
+      ::erasure::detail::any_support<__VA_ARGS__>>;                            \
+  EXTERN template struct ::erasure::any_t<                                     \
+      ::erasure::detail::get_options<__VA_ARGS__>>
+
+#define ERASURE_DETAIL_MODEL_INSTANTIATION(EXTERN, AnyType, T)                 \
+  EXTERN template struct ::erasure::detail::model_t<                           \
+      T, ::erasure::detail::any_vtbl<AnyType>>
+
+/** Declares the any type's machinery extern. */
+#define ERASURE_EXTERN_ANY(...)                                                \
+  ERASURE_DETAIL_ANY_INSTANTIATION(extern, __VA_ARGS__)
+/** Builds the any type's machinery in this translation unit. */
+#define ERASURE_INSTANTIATE_ANY(...)                                           \
+  ERASURE_DETAIL_ANY_INSTANTIATION(, __VA_ARGS__)
+
+/** Declares the model of T in AnyType extern. */
+#define ERASURE_EXTERN_MODEL(AnyType, T)                                       \
+  ERASURE_DETAIL_MODEL_INSTANTIATION(extern, AnyType, T)
+/** Builds the model of T in AnyType, with its vtable, in this translation
+ * unit. */
+#define ERASURE_INSTANTIATE_MODEL(AnyType, T)                                  \
+  ERASURE_DETAIL_MODEL_INSTANTIATION(, AnyType, T)
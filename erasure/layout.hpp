@@ -0,0 +1,163 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file layout.hpp
+ * The physical layout of any types, at compile time and at run time.
+ *
+ * `layout<Any>` describes the handle: its size, the size of its small buffer,
+ * and how big a value can be to land in it. `layout_for<Any, T>` describes
+ * the model that holds a T: its size and alignment, and whether it is placed
+ * inline. `debug::describe(x)` tells the same about the value an any holds.
+ *
+ * A model is the value plus the vtable pointer, so the buffer holds values
+ * up to `value_capacity` bytes, which is one pointer less than the buffer.
+ *
+ * The number of vtable slots is counted from the features: a feature that
+ * declares `static constexpr std::size_t vtable_slots` contributes that many,
+ * one whose vtbl is its base contributes none, and any other one. The
+ * destructor and the four queries every model answers (size, type, value
+ * identity, allocation) are the slots of an any without features.
+ */
+
+#include "erasure.hpp"
+
+#include <cstddef>
+#include <typeinfo>
+
+namespace erasure {
+namespace detail {
+/** Stands in for a vtbl base, to see whether a feature adds to it. */
+struct layout_vtbl_probe;
+
+template <typename Feature, typename = void>
+struct declared_vtable_slots {
+  static constexpr std::size_t value =
+      std::is_same<typename Feature::template vtbl<layout_vtbl_probe>,
+                   layout_vtbl_probe>{}
+          ? 0
+          : 1;
+};
+template <typename Feature>
+struct declared_vtable_slots<
+    Feature, std::void_t<decltype(Feature::vtable_slots)>> {
+  static constexpr std::size_t value = Feature::vtable_slots;
+};
+
+template <typename Tags>
+struct feature_counts;
+template <typename... Features>
+struct feature_counts<meta::typelist<Features...>> {
+  static constexpr std::size_t features = sizeof...(Features);
+  // the destructor, sizeof_alignof, target_type, value_identity and allocate
+  static constexpr std::size_t vtable_slots =
+      (std::size_t{5} + ... + declared_vtable_slots<Features>::value);
+};
+
+template <typename Any>
+using any_options_of = get_options<std::remove_cvref_t<Any>>;
+
+/** The buffer starts right after the pointer to the held model. */
+constexpr std::size_t buffer_alignment = alignof(void *);
+} // namespace detail
+
+template <typename Any>
+struct layout {
+  using options = detail::any_options_of<Any>;
+
+  /** sizeof the any itself. */
+  static constexpr std::size_t handle_size = sizeof(Any);
+  static constexpr std::size_t handle_align = alignof(Any);
+  /** The small buffer's size, as given by buffer_size<N>. */
+  static constexpr std::size_t capacity =
+      typename options::buffer_actual_size{};
+  /** The largest value, aligned at most like a pointer, that lands inline. */
+  static constexpr std::size_t value_capacity =
+      capacity / detail::buffer_alignment * detail::buffer_alignment >
+              sizeof(void *)
+          ? capacity / detail::buffer_alignment * detail::buffer_alignment -
+                sizeof(void *)
+          : 0;
+  /** The number of features, after flattening and deduplication. */
+  static constexpr std::size_t features =
+      detail::feature_counts<typename options::tags>::features;
+  /** The function entries in every model's vtable; see the file comment. */
+  static constexpr std::size_t vtable_slots =
+      detail::feature_counts<typename options::tags>::vtable_slots;
+};
+
+template <typename Any, typename T>
+struct layout_for : layout<Any> {
+  using model_type = typename detail::any_interface_t<
+      detail::any_options_of<Any>>::template model<T>;
+
+  static constexpr std::size_t value_size = sizeof(std::remove_cvref_t<T>);
+  static constexpr std::size_t model_size = sizeof(model_type);
+  static constexpr std::size_t model_align = alignof(model_type);
+  /**
+   * The buffer bytes a T needs to be placed inline wherever the any is: the
+   * model, and for models aligned more strictly than the buffer, the most
+   * padding that aligning them can take.
+   */
+  static constexpr std::size_t footprint =
+      model_size + (model_align > detail::buffer_alignment
+                        ? model_align - detail::buffer_alignment
+                        : 0);
+  /** Whether a T is always placed in the buffer. */
+  static constexpr bool fits_inline = footprint <= layout<Any>::capacity;
+  /** The bytes the buffer is short of always fitting a T, or 0. */
+  static constexpr std::size_t missing_bytes =
+      fits_inline ? 0 : footprint - layout<Any>::capacity;
+};
+
+namespace debug {
+/** The layout of the value an any holds. */
+struct description {
+  /** typeid(void) for an empty any. */
+  std::type_info const *value_type;
+  std::size_t handle_size;
+  std::size_t capacity;
+  std::size_t model_size;
+  std::size_t model_align;
+  std::size_t vtable_slots;
+  bool empty;
+  bool on_heap;
+};
+
+template <typename Options>
+auto describe(any_t<Options> const &x) -> description {
+  using any_layout = layout<any_t<Options>>;
+  description result{&typeid(void),
+                     any_layout::handle_size,
+                     any_layout::capacity,
+                     0,
+                     0,
+                     any_layout::vtable_slots,
+                     true,
+                     false};
+  if (erasure::concept_ptr(x)) {
+    auto const spec = erasure::call<detail::sizeof_alignof>(x);
+    result.value_type = &erasure::call<detail::target_type>(x);
+    result.model_size = spec.size;
+    result.model_align = spec.align;
+    result.empty = false;
+    result.on_heap = !detail::buffer_ref(x).is_internal();
+  }
+  return result;
+}
+} // namespace debug
+} // namespace erasure
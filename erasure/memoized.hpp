@@ -0,0 +1,288 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file memoized.hpp
+ * Erased pure functions with a cache of their results.
+ *
+ * memoized<R(Args...), Capacity, Eviction> holds a function<R(Args...) const>
+ * and an open-addressing cache of Capacity results inside the object, keyed
+ * by the arguments. A call looks for its arguments among the few slots after
+ * their hash, and calls the function only if they are not there; when those
+ * slots are all taken, Eviction picks the one to replace.
+ *
+ * sharded_memoized splits the cache into Shards caches behind a mutex each,
+ * picked by the hash, for callers on many threads. The function is called
+ * outside the lock, so it has to be safe to call concurrently.
+ *
+ * The arguments need std::hash and ==, and are stored decayed. Calls compare
+ * their arguments with the cached ones in place, and copy them only to cache
+ * a new result.
+ */
+
+#include "erasure.hpp"
+#include "feature/callable.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace erasure {
+
+/** What a memoized cache did so far. */
+struct memo_stats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;
+
+  auto hit_rate() const -> double {
+    auto const calls = hits + misses;
+    return calls == 0 ? 0.0
+                      : static_cast<double>(hits) / static_cast<double>(calls);
+  }
+  auto operator+=(memo_stats const &x) -> memo_stats & {
+    hits += x.hits;
+    misses += x.misses;
+    evictions += x.evictions;
+    return *this;
+  }
+};
+
+/** How often and when a cached result was used; eviction policies read it. */
+struct memo_use {
+  /** Ticks of the cache's clock, which advances on every call. */
+  std::uint64_t last_used;
+  std::uint64_t uses;
+};
+
+/**
+ * Eviction policies: among the slots a key may go to, the one with the
+ * lowest score is replaced.
+ */
+struct evict_least_recent {
+  static auto score(memo_use const &u) -> std::uint64_t { return u.last_used; }
+};
+struct evict_least_frequent {
+  static auto score(memo_use const &u) -> std::uint64_t { return u.uses; }
+};
+
+namespace detail {
+inline auto memo_mix(std::size_t h) -> std::uint64_t {
+  // spreads identity hashes, like those of integers, over all the bits
+  auto x = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15u;
+  return x ^ (x >> 32);
+}
+
+template <typename... Args>
+auto memo_hash(Args const &...args) -> std::uint64_t {
+  std::uint64_t h = 0;
+  ((h = memo_mix(h ^ std::hash<Args>{}(args))), ...);
+  return h;
+}
+
+/** A bounded cache of Capacity results, probed in windows of a few slots. */
+template <typename Key, typename Result, std::size_t Capacity,
+          typename Eviction>
+class memo_cache {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "The capacity must be a power of two.");
+  static constexpr std::size_t window = Capacity < 8 ? Capacity : 8;
+
+  struct entry {
+    std::uint64_t hash;
+    Key key;
+    Result result;
+    memo_use use;
+  };
+  std::array<std::optional<entry>, Capacity> slots_{};
+  std::uint64_t clock_ = 0;
+  memo_stats stats_;
+
+  auto slot(std::uint64_t hash, std::size_t i) -> std::optional<entry> & {
+    return slots_[(hash + i) & (Capacity - 1)];
+  }
+
+public:
+  /**
+   * The cached result for key, or null, which counts as a miss. key is any
+   * tuple that compares with Key, such as one of references to the arguments.
+   */
+  template <typename Probe>
+  auto find(std::uint64_t hash, Probe const &key) -> Result const * {
+    ++clock_;
+    for (std::size_t i = 0; i < window; ++i) {
+      auto &s = slot(hash, i);
+      if (s && s->hash == hash && s->key == key) {
+        ++stats_.hits;
+        s->use = {clock_, s->use.uses + 1};
+        return &s->result;
+      }
+    }
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  /**
+   * Caches result for a Key made from key, evicting another result if it has
+   * to.
+   */
+  template <typename Probe>
+  auto insert(std::uint64_t hash, Probe const &key, Result result)
+      -> Result const & {
+    std::optional<entry> *victim = nullptr;
+    for (std::size_t i = 0; i < window; ++i) {
+      auto &s = slot(hash, i);
+      if (!s) {
+        victim = &s;
+        break;
+      }
+      if (s->hash == hash && s->key == key) {
+        // cached meanwhile, by another caller
+        return s->result;
+      }
+      if (!victim || Eviction::score(s->use) < Eviction::score((*victim)->use)) {
+        victim = &s;
+      }
+    }
+    if (*victim) {
+      ++stats_.evictions;
+    }
+    victim->emplace(entry{hash, Key(key), std::move(result), {clock_, 1}});
+    return (*victim)->result;
+  }
+
+  auto stats() const -> memo_stats { return stats_; }
+  void clear() {
+    for (auto &s : slots_) {
+      s.reset();
+    }
+    stats_ = {};
+  }
+};
+} // namespace detail
+
+template <typename Signature, std::size_t Capacity = 64,
+          typename Eviction = evict_least_recent>
+class memoized;
+
+/**
+ * A function<R(Args...) const> with a cache of its last results. Calls are
+ * not thread-safe; see sharded_memoized.
+ */
+template <typename R, typename... Args, std::size_t Capacity,
+          typename Eviction>
+class memoized<R(Args...), Capacity, Eviction> {
+public:
+  using function_type = any<features::function<R(Args...) const>>;
+
+  memoized() = default;
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::remove_cvref_t<F>, memoized>>>
+  memoized(F &&f) : fn_(std::forward<F>(f)) {}
+
+  auto operator()(Args const &...args) -> R {
+    auto const hash = detail::memo_hash(args...);
+    auto const key = std::tie(args...);
+    if (auto const cached = cache_.find(hash, key)) {
+      return *cached;
+    }
+    return cache_.insert(hash, key, fn_(args...));
+  }
+
+  auto stats() const -> memo_stats { return cache_.stats(); }
+  /** Forgets the results and the stats. */
+  void clear() { cache_.clear(); }
+  auto function() const -> function_type const & { return fn_; }
+
+private:
+  using key_type = std::tuple<std::decay_t<Args>...>;
+  function_type fn_;
+  detail::memo_cache<key_type, R, Capacity, Eviction> cache_;
+};
+
+template <typename Signature, std::size_t Shards = 16,
+          std::size_t Capacity = 64, typename Eviction = evict_least_recent>
+class sharded_memoized;
+
+/**
+ * memoized for concurrent callers: Shards caches of Capacity results, each
+ * behind its own mutex.
+ */
+template <typename R, typename... Args, std::size_t Shards,
+          std::size_t Capacity, typename Eviction>
+class sharded_memoized<R(Args...), Shards, Capacity, Eviction> {
+public:
+  using function_type = any<features::function<R(Args...) const>>;
+
+  sharded_memoized() = default;
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::remove_cvref_t<F>, sharded_memoized>>>
+  sharded_memoized(F &&f) : fn_(std::forward<F>(f)) {}
+
+  auto operator()(Args const &...args) -> R {
+    auto const hash = detail::memo_hash(args...);
+    // the slots are picked by the low bits, so pick the shard by the high
+    auto &s = shards_[(hash >> 48) % Shards];
+    auto const key = std::tie(args...);
+    {
+      std::lock_guard lock(s.mutex);
+      if (auto const cached = s.cache.find(hash, key)) {
+        return *cached;
+      }
+    }
+    auto result = fn_(args...);
+    std::lock_guard lock(s.mutex);
+    return s.cache.insert(hash, key, std::move(result));
+  }
+
+  /** The stats of all the shards. */
+  auto stats() const -> memo_stats {
+    memo_stats total;
+    for (auto &s : shards_) {
+      std::lock_guard lock(s.mutex);
+      total += s.cache.stats();
+    }
+    return total;
+  }
+  void clear() {
+    for (auto &s : shards_) {
+      std::lock_guard lock(s.mutex);
+      s.cache.clear();
+    }
+  }
+  auto function() const -> function_type const & { return fn_; }
+
+private:
+  using key_type = std::tuple<std::decay_t<Args>...>;
+  // a cache line each, so that the shards' locks don't contend
+  struct alignas(64) shard {
+    mutable std::mutex mutex;
+    detail::memo_cache<key_type, R, Capacity, Eviction> cache;
+  };
+  function_type fn_;
+  std::array<shard, Shards> shards_;
+};
+
+} // namespace erasure
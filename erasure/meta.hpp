@@ -16,9 +16,32 @@
 
 #pragma once
 
+#include "type_hash.hpp"
+
+#include <cstddef>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
+/*
+ * The algorithms below avoid recursion over the elements of a typelist where
+ * they can: they compute indices with constexpr functions and pick elements
+ * by index, so their instantiation depth does not grow with the length of the
+ * list. The compiler's builtins are used for comparing types and for indexing
+ * packs where it has them.
+ */
+#if defined(__has_builtin)
+#if __has_builtin(__is_same)
+#define ERASURE_META_IS_SAME(...) __is_same(__VA_ARGS__)
+#endif
+#if __has_builtin(__type_pack_element)
+#define ERASURE_META_TYPE_PACK_ELEMENT 1
+#endif
+#endif
+#ifndef ERASURE_META_IS_SAME
+#define ERASURE_META_IS_SAME(...) std::is_same_v<__VA_ARGS__>
+#endif
+
 namespace erasure {
 namespace meta {
 
@@ -184,21 +207,125 @@ struct take_1<typelist<>> {
 template <typename Typelist>
 using take_1_t = _t<take_1<Typelist>>;
 
-/** concatenate */
-template <typename... Typelists>
-struct concatenate;
+/** typelist length. */
+template <typename Typelist>
+struct len;
+template <typename... Ts>
+struct len<typelist<Ts...>>
+    : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+template <typename Typelist>
+using len_t = typename len<Typelist>::type;
 
-template <>
-struct concatenate<> {
-  using type = typelist<>;
+/** at: the I-th type of a pack. */
+#ifdef ERASURE_META_TYPE_PACK_ELEMENT
+template <std::size_t I, typename... Ts>
+using at_t = __type_pack_element<I, Ts...>;
+#else
+template <std::size_t I, typename T>
+struct indexed {
+  using type = T;
 };
-template <typename... Ts>
-struct concatenate<typelist<Ts...>> {
-  using type = typelist<Ts...>;
+template <typename Indices, typename... Ts>
+struct indexer;
+template <std::size_t... Is, typename... Ts>
+struct indexer<std::index_sequence<Is...>, Ts...> : indexed<Is, Ts>... {};
+template <std::size_t I, typename T>
+auto select_indexed(indexed<I, T> const &) -> indexed<I, T>;
+template <std::size_t I, typename... Ts>
+using at_t = _t<decltype(detail::select_indexed<I>(
+    std::declval<indexer<std::index_sequence_for<Ts...>, Ts...> const &>()))>;
+#endif
+
+/** The indices at which Mask is true, as a std::index_sequence. */
+template <bool... Mask>
+struct indices_where {
+  static constexpr std::size_t count = (std::size_t{0} + ... + Mask);
+  struct positions {
+    std::size_t at[count == 0 ? 1 : count];
+  };
+  static constexpr auto find() -> positions {
+    constexpr bool mask[] = {Mask..., false};
+    positions result{};
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < sizeof...(Mask); ++i) {
+      if (mask[i]) {
+        result.at[found++] = i;
+      }
+    }
+    return result;
+  }
+  static constexpr positions found = find();
+
+  template <std::size_t... Ks>
+  static auto make(std::index_sequence<Ks...>)
+      -> std::index_sequence<found.at[Ks]...>;
+  using type = decltype(make(std::make_index_sequence<count>{}));
+};
+template <bool... Mask>
+using indices_where_t = _t<indices_where<Mask...>>;
+
+/** pick: the types of a pack at the given indices. */
+template <typename Indices, typename... Ts>
+struct pick;
+template <std::size_t... Is, typename... Ts>
+struct pick<std::index_sequence<Is...>, Ts...> {
+  using type = typelist<at_t<Is, Ts...>...>;
+};
+template <typename Indices, typename... Ts>
+using pick_t = _t<pick<Indices, Ts...>>;
+
+/** typelist_at: the I-th type of a typelist. */
+template <std::size_t I, typename Typelist>
+struct typelist_at;
+template <std::size_t I, typename... Ts>
+struct typelist_at<I, typelist<Ts...>> {
+  using type = at_t<I, Ts...>;
 };
-template <typename... Ts1, typename... Ts2, typename... Typelists>
-struct concatenate<typelist<Ts1...>, typelist<Ts2...>, Typelists...> {
-  using type = _t<concatenate<typelist<Ts1..., Ts2...>, Typelists...>>;
+
+/** Whether T is one of Ts. */
+template <typename T, typename... Ts>
+constexpr bool contains_v = (ERASURE_META_IS_SAME(T, Ts) || ...);
+
+/** Whether the I-th type of Ts is the first of its kind. */
+template <std::size_t I, typename... Ts>
+constexpr bool first_occurrence_v = [] {
+  constexpr bool same[] = {ERASURE_META_IS_SAME(at_t<I, Ts...>, Ts)...};
+  for (std::size_t j = 0; j < I; ++j) {
+    if (same[j]) {
+      return false;
+    }
+  }
+  return true;
+}();
+
+/** concatenate */
+template <typename... Typelists>
+struct concatenate {
+  static_assert((is_typelist<Typelists>{} && ...),
+                "All parameters should be typelists.");
+
+  static constexpr std::size_t count =
+      (std::size_t{0} + ... + len<Typelists>{});
+  struct position {
+    std::size_t list;
+    std::size_t index;
+  };
+  /** Where the element with index i of the concatenation comes from. */
+  static constexpr auto locate(std::size_t i) -> position {
+    constexpr std::size_t lengths[] = {len<Typelists>{}..., 0};
+    std::size_t list = 0;
+    while (i >= lengths[list]) {
+      i -= lengths[list];
+      ++list;
+    }
+    return {list, i};
+  }
+
+  template <std::size_t... Is>
+  static auto make(std::index_sequence<Is...>)
+      -> typelist<_t<typelist_at<locate(Is).index,
+                                 at_t<locate(Is).list, Typelists...>>>...>;
+  using type = decltype(make(std::make_index_sequence<count>{}));
 };
 template <typename... Typelists>
 using concatenate_t = _t<concatenate<Typelists...>>;
@@ -273,6 +400,9 @@ using make_index_sequence_t = _t<make_index_sequence<N>>;
  * foldl
  *
  * foldl(f, acc, (a, b, c))
+ *
+ * Every step depends on the one before, so the folds recurse; they take eight
+ * steps per instantiation to keep the depth down.
  */
 template <template <typename, typename> class BinaryF, typename Acc,
           typename Typelist>
@@ -291,6 +421,20 @@ struct foldl<BinaryF, Acc, typelist<T, Rest...>> {
   using r_type = BinaryF<Acc, T>;
   using type = _t<foldl<BinaryF, r_type, typelist<Rest...>>>;
 };
+template <template <typename, typename> class BinaryF, typename Acc,
+          typename T0, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename... Rest>
+struct foldl<BinaryF, Acc, typelist<T0, T1, T2, T3, T4, T5, T6, T7, Rest...>> {
+  using r_type = BinaryF<
+      BinaryF<BinaryF<BinaryF<BinaryF<BinaryF<BinaryF<BinaryF<Acc, T0>, T1>,
+                                              T2>,
+                                      T3>,
+                              T4>,
+                      T5>,
+              T6>,
+      T7>;
+  using type = _t<foldl<BinaryF, r_type, typelist<Rest...>>>;
+};
 template <template <typename, typename> class BinaryF, typename Acc,
           typename Typelist>
 using foldl_t = _t<foldl<BinaryF, Acc, Typelist>>;
@@ -312,6 +456,22 @@ struct foldr<BinaryF, typelist<T, Rest...>, Acc> {
   using r_type = _t<foldr<BinaryF, typelist<Rest...>, Acc>>;
   using type = BinaryF<T, r_type>;
 };
+template <template <typename, typename> class BinaryF, typename T0,
+          typename T1, typename T2, typename T3, typename T4, typename T5,
+          typename T6, typename T7, typename... Rest, typename Acc>
+struct foldr<BinaryF, typelist<T0, T1, T2, T3, T4, T5, T6, T7, Rest...>, Acc> {
+  using r_type = _t<foldr<BinaryF, typelist<Rest...>, Acc>>;
+  using type = BinaryF<
+      T0,
+      BinaryF<
+          T1,
+          BinaryF<
+              T2,
+              BinaryF<
+                  T3,
+                  BinaryF<T4,
+                          BinaryF<T5, BinaryF<T6, BinaryF<T7, r_type>>>>>>>>;
+};
 template <template <typename, typename> class BinaryF, typename Typelist,
           typename Acc>
 using foldr_t = _t<foldr<BinaryF, Typelist, Acc>>;
@@ -325,10 +485,16 @@ static_assert(type_<foldr_t<pair_t, typelist<>, long>>{} == type_<long>{},
 template <template <typename...> class NaryPredicate, typename Typelist,
           typename... PredicateParams>
 struct copy_if {
-  template <typename T>
-  using predicate = std::conditional_t<NaryPredicate<T, PredicateParams...>{},
-                                       typelist<T>, typelist<>>;
-  using type = join_t<map_t<predicate, Typelist>>;
+  static auto Typelist_is_this = print_type<Typelist>;
+  static_assert(is_typelist<Typelist>{},
+                "The typelist parameter should be a typelist.");
+};
+template <template <typename...> class NaryPredicate, typename... Ts,
+          typename... PredicateParams>
+struct copy_if<NaryPredicate, typelist<Ts...>, PredicateParams...> {
+  using type = pick_t<indices_where_t<static_cast<bool>(
+                          NaryPredicate<Ts, PredicateParams...>{})...>,
+                      Ts...>;
 };
 template <template <typename...> class NaryPredicate, typename Typelist,
           typename... PredicateParams>
@@ -388,38 +554,58 @@ template <template <typename...> class NaryPredicate, typename Typelist,
 using find_first_not =
     type_<find_first_not_t<NaryPredicate, Typelist, PredicateParams...>>;
 
-/** unique */
+/**
+ * unique: the first of every kind of element, in order. Equals must be an
+ * equivalence.
+ */
 template <typename Typelist, template <typename, typename> class Equals>
-struct unique {
-  template <typename Result, typename T>
-  using include_if_not_in =
-      std::conditional_t<typelist<>{} == copy_if_t<Equals, Result, T>{},
-                         concatenate_t<Result, typelist<T>>, Result>;
-
-  using type = foldl_t<include_if_not_in, typelist<>, Typelist>;
+struct unique;
+template <typename... Ts, template <typename, typename> class Equals>
+struct unique<typelist<Ts...>, Equals> {
+  template <std::size_t I, std::size_t... Js>
+  static constexpr auto is_first(std::index_sequence<Js...>) -> bool {
+    return !(static_cast<bool>(Equals<at_t<Js, Ts...>, at_t<I, Ts...>>{}) ||
+             ...);
+  }
+  template <std::size_t... Is>
+  static auto make(std::index_sequence<Is...>) -> pick_t<
+      indices_where_t<is_first<Is>(std::make_index_sequence<Is>{})...>,
+      Ts...>;
+  using type = decltype(make(std::index_sequence_for<Ts...>{}));
+};
+template <typename... Ts>
+struct unique<typelist<Ts...>, std::is_same> {
+  template <std::size_t... Is>
+  static auto make(std::index_sequence<Is...>)
+      -> pick_t<indices_where_t<first_occurrence_v<Is, Ts...>...>, Ts...>;
+  using type = decltype(make(std::index_sequence_for<Ts...>{}));
 };
 template <typename Typelist,
           template <typename, typename> class Equals = is_same>
 using unique_t = _t<unique<Typelist, Equals>>;
 
+/** unique_by: the first element with every Key<T>, in order. */
+template <typename Typelist, template <typename> class Key>
+struct unique_by;
+template <typename... Ts, template <typename> class Key>
+struct unique_by<typelist<Ts...>, Key> {
+  template <std::size_t... Is>
+  static auto make(std::index_sequence<Is...>)
+      -> pick_t<indices_where_t<first_occurrence_v<Is, Key<Ts>...>...>, Ts...>;
+  using type = decltype(make(std::index_sequence_for<Ts...>{}));
+};
+template <typename Typelist, template <typename> class Key>
+using unique_by_t = _t<unique_by<Typelist, Key>>;
+
 static_assert(typelist<int, long, char>{} ==
                   unique_t<typelist<int, long, int, long, char, long>>{},
               "");
 
-/** typelist length. */
-template <typename Typelist>
-struct len;
-template <typename... Ts>
-struct len<typelist<Ts...>>
-    : std::integral_constant<std::size_t, sizeof...(Ts)> {};
-template <typename Typelist>
-using len_t = typename len<Typelist>::type;
-
 template <typename S1, typename S2>
-struct intersection {
-  template <typename T>
-  using predicate = take_1_t<copy_if_t<is_same, S2, T>>;
-  using type = join_t<map_t<predicate, S1>>;
+struct intersection;
+template <typename... Ts, typename... Us>
+struct intersection<typelist<Ts...>, typelist<Us...>> {
+  using type = pick_t<indices_where_t<contains_v<Ts, Us...>...>, Ts...>;
 };
 template <typename Set1, typename Set2>
 using intersection_t = _t<intersection<Set1, Set2>>;
@@ -433,8 +619,10 @@ static_assert(typelist<>{} ==
               "");
 
 template <typename Subset, typename Set>
-struct is_subset_of {
-  using type = is_same_t<len<Subset>, len<intersection_t<Subset, Set>>>;
+struct is_subset_of;
+template <typename... Ts, typename... Us>
+struct is_subset_of<typelist<Ts...>, typelist<Us...>> {
+  using type = std::bool_constant<(contains_v<Ts, Us...> && ...)>;
 };
 template <typename Subset, typename Set>
 using is_subset_of_t = _t<is_subset_of<Subset, Set>>;
@@ -476,29 +664,123 @@ static_assert(is_not_element_t<unsigned int, typelist<long, int, char>>{},
               "Long typelist is fine.");
 
 template <template <typename> class Predicate, typename Typelist>
-using any_t = foldl_t<or_, std::false_type, map_t<Predicate, Typelist>>;
+struct any_of;
+template <template <typename> class Predicate, typename... Ts>
+struct any_of<Predicate, typelist<Ts...>> {
+  using type = std::bool_constant<(static_cast<bool>(Predicate<Ts>{}) || ...)>;
+};
+template <template <typename> class Predicate, typename Typelist>
+using any_t = _t<any_of<Predicate, Typelist>>;
 template <template <typename> class Predicate, typename Typelist>
 using any = type_<any_t<Predicate, Typelist>>;
 
 template <template <typename> class Predicate, typename Typelist>
-using all_t = foldl_t<and_, std::true_type, map_t<Predicate, Typelist>>;
+struct all_of;
+template <template <typename> class Predicate, typename... Ts>
+struct all_of<Predicate, typelist<Ts...>> {
+  using type = std::bool_constant<(static_cast<bool>(Predicate<Ts>{}) && ...)>;
+};
+template <template <typename> class Predicate, typename Typelist>
+using all_t = _t<all_of<Predicate, Typelist>>;
 template <template <typename> class Predicate, typename Typelist>
 using all = type_<all_t<Predicate, Typelist>>;
 
 template <template <typename, typename> class Equals, typename Typelist>
 struct group_by;
+/**
+ * group_by: the classes of Equals, which must be an equivalence, in the order
+ * of their first elements.
+ */
 template <template <typename, typename> class Equals, typename... Ts>
 struct group_by<Equals, typelist<Ts...>> {
   using ts = typelist<Ts...>;
-  using type = unique_t<typelist<copy_if_t<Equals, ts, Ts>...>>;
+  template <typename... Firsts>
+  static auto make(typelist<Firsts...>)
+      -> typelist<copy_if_t<Equals, ts, Firsts>...>;
+  using type = decltype(make(unique_t<ts, Equals>{}));
 };
 template <template <typename, typename> class Equals, typename Typelist>
 using group_by_t = _t<group_by<Equals, Typelist>>;
 
+/** group_by_key: the elements grouped by Key<T>, in order of first keys. */
+template <template <typename> class Key, typename Typelist>
+struct group_by_key;
+template <template <typename> class Key, typename... Ts>
+struct group_by_key<Key, typelist<Ts...>> {
+  template <typename K>
+  using group =
+      pick_t<indices_where_t<ERASURE_META_IS_SAME(Key<Ts>, K)...>, Ts...>;
+  template <typename... Firsts>
+  static auto make(typelist<Firsts...>) -> typelist<group<Key<Firsts>>...>;
+  using type = decltype(make(unique_by_t<typelist<Ts...>, Key>{}));
+};
+template <template <typename> class Key, typename Typelist>
+using group_by_key_t = _t<group_by_key<Key, Typelist>>;
+
+static_assert(
+    is_same_t<typelist<typelist<int, int const>, typelist<long, long>>,
+              group_by_key_t<std::remove_const_t,
+                             typelist<int, long, int const, long>>>{},
+    "General test.");
+
 static_assert(is_same_t<typelist<typelist<int, int>, typelist<long, long>>,
                         group_by_t<is_same, typelist<int, long, int, long>>>{},
               "General test.");
 
+/**
+ * sort_name: T::sort_key where T declares one, else erasure::type_name<T>().
+ * Compilers spell some type names differently (GCC's "long int" is Clang's
+ * "long"), so types that must sort the same way under every compiler
+ * declare a sort_key.
+ */
+template <typename T>
+constexpr auto sort_name() -> std::string_view {
+  if constexpr (requires { std::string_view{T::sort_key}; }) {
+    return T::sort_key;
+  } else {
+    return erasure::type_name<T>();
+  }
+}
+
+/**
+ * sort_by_name: the elements ordered by sort_name, which orders them the same
+ * way in every translation unit built by the same compiler; equal names keep
+ * order.
+ */
+template <typename Typelist>
+struct sort_by_name;
+template <typename... Ts>
+struct sort_by_name<typelist<Ts...>> {
+  struct positions {
+    std::size_t at[sizeof...(Ts) + 1];
+  };
+  static constexpr auto find() -> positions {
+    constexpr std::string_view names[] = {sort_name<Ts>()..., {}};
+    positions result{};
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+      std::size_t rank = 0;
+      for (std::size_t j = 0; j < sizeof...(Ts); ++j) {
+        rank += names[j] < names[i] || (names[j] == names[i] && j < i);
+      }
+      result.at[rank] = i;
+    }
+    return result;
+  }
+  static constexpr positions sorted = find();
+
+  template <std::size_t... Ks>
+  static auto make(std::index_sequence<Ks...>)
+      -> typelist<at_t<sorted.at[Ks], Ts...>...>;
+  using type = decltype(make(std::index_sequence_for<Ts...>{}));
+};
+template <typename Typelist>
+using sort_by_name_t = _t<sort_by_name<Typelist>>;
+
+static_assert(is_same_t<sort_by_name_t<typelist<int, long, char>>,
+                        sort_by_name_t<typelist<char, int, long>>>{},
+              "Permutations sort the same.");
+static_assert(typelist<>{} == sort_by_name_t<typelist<>>{}, "");
+
 /** product_2 */
 template <typename, typename>
 struct product_2;
@@ -673,6 +955,9 @@ using detail::map_t;
 using detail::unique;
 using detail::unique_t;
 
+using detail::unique_by;
+using detail::unique_by_t;
+
 using detail::any;
 using detail::any_t;
 
@@ -685,6 +970,18 @@ using detail::make_index_sequence_t;
 using detail::group_by;
 using detail::group_by_t;
 
+using detail::group_by_key;
+using detail::group_by_key_t;
+
+using detail::sort_by_name;
+using detail::sort_by_name_t;
+using detail::sort_name;
+using erasure::type_name;
+
+using detail::at_t;
+using detail::len;
+using detail::len_t;
+
 using detail::product;
 using detail::product_t;
 
@@ -707,3 +1004,6 @@ using detail::print_type;
 
 } // namespace meta
 } // namespace erasure
+
+#undef ERASURE_META_IS_SAME
+#undef ERASURE_META_TYPE_PACK_ELEMENT
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file core.cppm
+ * The erasure:core partition: any, the construction features and the
+ * feature_support namespace.
+ */
+
+module;
+
+#include "erasure/erasure.hpp"
+#include "erasure/layout.hpp"
+
+export module erasure:core;
+
+export namespace erasure {
+using erasure::any;
+using erasure::any_t;
+using erasure::buffer_size;
+using erasure::call;
+using erasure::concept_ptr;
+using erasure::copy_assignable;
+using erasure::copy_constructible;
+using erasure::copyable;
+using erasure::erased_value;
+using erasure::feature;
+using erasure::ifc;
+using erasure::layout;
+using erasure::layout_for;
+using erasure::make_any;
+using erasure::make_any_like;
+using erasure::movable;
+using erasure::move_assignable;
+using erasure::move_constructible;
+using erasure::pack_scalars;
+using erasure::same_dynamic_type;
+using erasure::self;
+using erasure::self_cast;
+using erasure::swappable;
+using erasure::tag;
+using erasure::tag_t;
+using erasure::target;
+using erasure::target_type;
+using erasure::type_hash;
+using erasure::type_name;
+using erasure::value;
+using erasure::vtbl;
+
+namespace debug {
+using erasure::debug::describe;
+using erasure::debug::description;
+using erasure::debug::model_size;
+} // namespace debug
+
+namespace meta {
+using erasure::meta::typelist;
+} // namespace meta
+
+namespace feature_support {
+using erasure::feature_support::any;
+using erasure::feature_support::call;
+using erasure::feature_support::concept_ptr;
+using erasure::feature_support::feature;
+using erasure::feature_support::ifc;
+using erasure::feature_support::make_any;
+using erasure::feature_support::make_any_like;
+using erasure::feature_support::same_dynamic_type;
+using erasure::feature_support::self;
+using erasure::feature_support::self_cast;
+using erasure::feature_support::tag;
+using erasure::feature_support::tag_t;
+using erasure::feature_support::target;
+using erasure::feature_support::target_type;
+using erasure::feature_support::typelist;
+using erasure::feature_support::value;
+using erasure::feature_support::vtbl;
+} // namespace feature_support
+
+namespace features {
+using erasure::features::buffer_size;
+using erasure::features::copy_assignable;
+using erasure::features::copy_constructible;
+using erasure::features::copyable;
+using erasure::features::movable;
+using erasure::features::move_assignable;
+using erasure::features::move_constructible;
+using erasure::features::pack_scalars;
+using erasure::features::swappable;
+} // namespace features
+} // namespace erasure
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file equality_comparable.cppm The erasure:equality_comparable partition. */
+
+module;
+
+#include "erasure/feature/equality_comparable.hpp"
+
+export module erasure:equality_comparable;
+
+export namespace erasure::features {
+using erasure::features::equality_comparable;
+} // namespace erasure::features
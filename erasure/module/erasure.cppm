@@ -0,0 +1,51 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file erasure.cppm
+ * The erasure module: the library and all its features.
+ *
+ * Exports what the headers make public: any and its helpers, the
+ * feature_support namespace for writing features, the features namespace,
+ * and the arena, bulk, memoized, open_method, persistent_vector and prefetch
+ * utilities. The macros (ERASURE_INSTANTIATE_ANY and friends) do not cross a
+ * module boundary, and neither do the hooks and telemetry namespaces, which
+ * only exist under their configuration macros; include the headers for those.
+ *
+ * The configuration macros (ERASURE_HOOKS, ERASURE_ENABLE_PROFILING,
+ * ERASURE_SPILL_TELEMETRY, ERASURE_CHECK_TYPE_HASHES) are fixed when the
+ * module is built, so define them for the erasure_module target, not for its
+ * users.
+ */
+
+export module erasure;
+
+export import :core;
+export import :arena;
+export import :bulk;
+export import :callable;
+export import :dereferenceable;
+export import :equality_comparable;
+export import :less_than_comparable;
+export import :memoized;
+export import :open_method;
+export import :ostreamable;
+export import :persistent_vector;
+export import :pointer_like;
+export import :prefetch;
+export import :profiled;
+export import :regular;
+export import :value_equality_comparable;
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file open_method.hpp
+ * Operations on anys that are not features of their type.
+ *
+ * An open_method<R(Args...)> is a table of implementations, one per value
+ * type, keyed by type_hash<T>(). Calling it on an any of any type asks the
+ * model for its value and type hash in one call through the vtable, finds
+ * the implementation for that type in the table, mostly in the first slot it
+ * looks at, and calls it directly. The any types involved don't change, so
+ * adding a method recompiles only the code that uses it. Being keyed by type
+ * hash, a method defined in one shared object works on anys made in another.
+ *
+ * Implementations take the value as T const & and the arguments, and are
+ * defined either as a function known at compile time,
+ *
+ *     area.define<circle, &circle_area>();
+ *
+ * or as a lambda without captures,
+ *
+ *     area.define<square>([](square const &s) { return s.side * s.side; });
+ *
+ * T must have a type_hash, so not be a closure, a local class or in an unnamed
+ * namespace. Define them before calling the method from other threads, for
+ * example while initializing statics. Calls for a type with no
+ * implementation throw bad_open_method_call.
+ */
+
+#include "demangle.hpp"
+#include "erasure.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace erasure {
+
+/** Thrown by calls of an open_method on a type it has no implementation for. */
+struct bad_open_method_call : std::logic_error {
+  using std::logic_error::logic_error;
+};
+
+template <typename Signature>
+class open_method;
+
+template <typename R, typename... Args>
+class open_method<R(Args...)> {
+public:
+  /** What the table holds: the implementation for one type. */
+  using thunk = R (*)(void const *value, Args... args);
+
+  /** Implements the method for T with Fn, a function or constant. */
+  template <typename T, auto Fn>
+  auto define() -> open_method & {
+    return define_thunk<T>([](void const *value, Args... args) -> R {
+      return std::invoke(Fn, *static_cast<T const *>(value),
+                         std::forward<Args>(args)...);
+    });
+  }
+  /** Implements the method for T with f, which must not hold any state. */
+  template <typename T, typename F>
+    requires std::is_empty_v<F> && std::is_default_constructible_v<F>
+  auto define(F) -> open_method & {
+    return define_thunk<T>([](void const *value, Args... args) -> R {
+      return std::invoke(F{}, *static_cast<T const *>(value),
+                         std::forward<Args>(args)...);
+    });
+  }
+
+  /** If the method has an implementation for T. */
+  template <typename T>
+  auto defines() const -> bool {
+    return find(type_hash<std::remove_cv_t<T>>()) != nullptr;
+  }
+  /** If the method can be called on x. */
+  template <typename AnyOptions>
+  auto defines(any_t<AnyOptions> const &x) const -> bool {
+    return !empty(x) &&
+           find(erasure::call<detail::value_identity>(x).type_hash) != nullptr;
+  }
+
+  template <typename AnyOptions>
+  auto operator()(any_t<AnyOptions> const &x, Args... args) const -> R {
+    if (empty(x)) {
+      throw bad_open_method_call("open_method called on an empty any");
+    }
+    auto const v = erasure::call<detail::value_identity>(x);
+    auto const impl = find(v.type_hash);
+    if (!impl) {
+      throw bad_open_method_call(
+          "open_method has no implementation for " +
+          detail::demangle(erasure::call<detail::target_type>(x).name()));
+    }
+    return impl(v.value, std::forward<Args>(args)...);
+  }
+
+private:
+  struct slot {
+    std::uint64_t hash;
+    thunk impl; // null in free slots
+  };
+  /** Open addressing, at most half full, so probes are short. */
+  std::vector<slot> table_;
+  std::size_t defined_ = 0;
+
+  auto home(std::uint64_t hash) const -> std::size_t {
+    // the low bits of FNV-1a are mixed well enough
+    return static_cast<std::size_t>(hash) & (table_.size() - 1);
+  }
+  template <typename T>
+  auto define_thunk(thunk impl) -> open_method & {
+    static_assert(has_type_hash<std::remove_cv_t<T>>,
+                  "open_methods are keyed by type_hash, which closures, "
+                  "local classes and types in unnamed namespaces don't have");
+    auto const hash = detail::checked_type_hash<std::remove_cv_t<T>>();
+    if (2 * (defined_ + 1) > table_.size()) {
+      grow();
+    }
+    place(hash, impl);
+    return *this;
+  }
+  void place(std::uint64_t hash, thunk impl) {
+    for (auto i = home(hash);; i = (i + 1) & (table_.size() - 1)) {
+      if (!table_[i].impl) {
+        table_[i] = {hash, impl};
+        ++defined_;
+        return;
+      }
+      if (table_[i].hash == hash) {
+        table_[i].impl = impl;
+        return;
+      }
+    }
+  }
+  void grow() {
+    auto old = std::move(table_);
+    table_.assign(old.empty() ? 16 : 2 * old.size(), slot{0, nullptr});
+    defined_ = 0;
+    for (auto const &s : old) {
+      if (s.impl) {
+        place(s.hash, s.impl);
+      }
+    }
+  }
+  auto find(std::uint64_t hash) const -> thunk {
+    if (table_.empty()) {
+      return nullptr;
+    }
+    for (auto i = home(hash);; i = (i + 1) & (table_.size() - 1)) {
+      if (!table_[i].impl || table_[i].hash == hash) {
+        return table_[i].impl;
+      }
+    }
+  }
+};
+
+} // namespace erasure
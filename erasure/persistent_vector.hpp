@@ -0,0 +1,591 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file persistent_vector.hpp
+ * Versions of a vector of anys that share what they have in common.
+ *
+ * A persistent_any_vector<Any> never changes: push_back, set and pop_back
+ * return a new version and leave the old one as it was. The anys are stored
+ * inline, 32 to a chunk, at the leaves of a 32-way trie, and versions share
+ * chunks and inner nodes through reference counts. Copying a version costs
+ * one reference count each for the root and the last chunk; an update copies
+ * the nodes on the path to one chunk and the anys in that chunk. The last
+ * chunk is kept out of the trie, so push_back mostly copies only it.
+ *
+ * Batches of updates go through a transient_any_vector, which makes the same
+ * copies the first time it touches a shared node and changes the nodes only
+ * it refers to in place from then on:
+ *
+ *     auto t = v.transient();
+ *     for (auto const &x : xs) {
+ *       t.push_back(x);
+ *     }
+ *     v = std::move(t).persistent();
+ *
+ * Versions may be read, copied and destroyed on any thread. for_each_chunk
+ * and the iterators read a chunk at a time, so going over a version touches
+ * memory much like going over a std::vector would.
+ */
+
+#include "erasure.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace erasure {
+namespace detail {
+inline constexpr unsigned pvec_bits = 5;
+inline constexpr std::size_t pvec_width = std::size_t{1} << pvec_bits;
+inline constexpr std::size_t pvec_mask = pvec_width - 1;
+
+struct pvec_node {
+  std::atomic<std::size_t> refs{1};
+
+  void retain() { refs.fetch_add(1, std::memory_order_relaxed); }
+  /** Drops a reference; true if it was the last one. */
+  auto drop() -> bool {
+    return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+  auto unique() const -> bool {
+    return refs.load(std::memory_order_acquire) == 1;
+  }
+};
+
+/** Nodes at level 5 and up; children to the left of a null one are set. */
+struct pvec_inner : pvec_node {
+  pvec_node *children[pvec_width] = {};
+};
+
+/** Up to 32 anys, at level 0. Only the last chunk of a vector isn't full. */
+template <typename Any>
+struct pvec_chunk : pvec_node {
+  std::size_t count = 0;
+  union {
+    Any values[pvec_width];
+  };
+
+  pvec_chunk() {}
+  pvec_chunk(pvec_chunk const &other) : pvec_node{} {
+    try {
+      for (; count < other.count; ++count) {
+        new (&values[count]) Any(other.values[count]);
+      }
+    } catch (...) {
+      destroy();
+      throw;
+    }
+  }
+  auto operator=(pvec_chunk const &) -> pvec_chunk & = delete;
+  ~pvec_chunk() { destroy(); }
+
+private:
+  void destroy() {
+    while (count > 0) {
+      values[--count].~Any();
+    }
+  }
+};
+
+/** The representation both persistent_any_vector and transient use. */
+template <typename Any>
+class pvec_tree {
+public:
+  using chunk = pvec_chunk<Any>;
+
+  pvec_tree() = default;
+  pvec_tree(pvec_tree const &x)
+      : size_{x.size_}, shift_{x.shift_}, root_{x.root_}, tail_{x.tail_} {
+    if (root_) {
+      root_->retain();
+    }
+    if (tail_) {
+      tail_->retain();
+    }
+  }
+  pvec_tree(pvec_tree &&x) noexcept
+      : size_{std::exchange(x.size_, 0)},
+        shift_{std::exchange(x.shift_, pvec_bits)},
+        root_{std::exchange(x.root_, nullptr)},
+        tail_{std::exchange(x.tail_, nullptr)} {}
+  auto operator=(pvec_tree x) noexcept -> pvec_tree & {
+    std::swap(size_, x.size_);
+    std::swap(shift_, x.shift_);
+    std::swap(root_, x.root_);
+    std::swap(tail_, x.tail_);
+    return *this;
+  }
+  ~pvec_tree() {
+    release(root_, shift_);
+    release(tail_, 0);
+  }
+
+  auto size() const -> std::size_t { return size_; }
+
+  /** The chunk holding element i. */
+  auto chunk_for(std::size_t i) const -> chunk const * {
+    if (i >= tail_offset()) {
+      return tail_;
+    }
+    pvec_node const *n = root_;
+    for (auto level = shift_; level > 0; level -= pvec_bits) {
+      n = static_cast<pvec_inner const *>(n)->children[(i >> level) &
+                                                       pvec_mask];
+    }
+    return static_cast<chunk const *>(n);
+  }
+  auto operator[](std::size_t i) const -> Any const & {
+    return chunk_for(i)->values[i & pvec_mask];
+  }
+
+  /** Element i, in a chunk only this tree refers to. */
+  auto mutable_at(std::size_t i) -> Any & {
+    if (i >= tail_offset()) {
+      tail_ = own(tail_);
+      return tail_->values[i & pvec_mask];
+    }
+    root_ = own(root_, shift_);
+    auto n = root_;
+    for (auto level = shift_; level > pvec_bits; level -= pvec_bits) {
+      auto &slot = n->children[(i >> level) & pvec_mask];
+      n = own(static_cast<pvec_inner *>(slot), level - pvec_bits);
+      slot = n;
+    }
+    auto &slot = n->children[(i >> pvec_bits) & pvec_mask];
+    auto const c = own(static_cast<chunk *>(slot));
+    slot = c;
+    return c->values[i & pvec_mask];
+  }
+
+  template <typename V>
+  void set(std::size_t i, V &&x) {
+    auto &slot = mutable_at(i);
+    if constexpr (std::is_same_v<std::remove_cvref_t<V>, Any>) {
+      slot = std::forward<V>(x);
+    } else {
+      slot = Any(std::forward<V>(x));
+    }
+  }
+
+  template <typename V>
+  void push_back(V &&x) {
+    if (tail_ && tail_->count < pvec_width) {
+      tail_ = own(tail_);
+      new (&tail_->values[tail_->count]) Any(std::forward<V>(x));
+      ++tail_->count;
+    } else {
+      auto const next = new chunk;
+      try {
+        new (&next->values[0]) Any(std::forward<V>(x));
+        next->count = 1;
+        if (tail_) {
+          push_tail();
+        }
+      } catch (...) {
+        delete next;
+        throw;
+      }
+      release(tail_, 0);
+      tail_ = next;
+    }
+    ++size_;
+  }
+
+  void pop_back() {
+    assert(size_ > 0 && "pop_back on an empty vector");
+    if (tail_->count > 1) {
+      tail_ = own(tail_);
+      tail_->values[--tail_->count].~Any();
+    } else if (root_) {
+      // the trie's last chunk becomes the tail
+      auto const at = size_ - 2;
+      auto const last = const_cast<chunk *>(chunk_for(at));
+      last->retain();
+      try {
+        pop_tail(at);
+      } catch (...) {
+        last->drop();
+        throw;
+      }
+      release(tail_, 0);
+      tail_ = last;
+    } else {
+      release(tail_, 0);
+      tail_ = nullptr;
+    }
+    --size_;
+  }
+
+  /** Calls fn with a std::span<Any const> of every chunk, in order. */
+  template <typename Fn>
+  void for_each_chunk(Fn &fn) const {
+    if (root_) {
+      visit(root_, shift_, fn);
+    }
+    if (tail_) {
+      fn(std::span<Any const>(tail_->values, tail_->count));
+    }
+  }
+
+private:
+  std::size_t size_ = 0;
+  /** The level of the root; its children are at shift_ - 5. */
+  unsigned shift_ = pvec_bits;
+  /** Null while the tail holds all the elements. */
+  pvec_inner *root_ = nullptr;
+  /** Null only when empty. */
+  chunk *tail_ = nullptr;
+
+  /** Where the tail's elements start. */
+  auto tail_offset() const -> std::size_t {
+    return size_ < pvec_width ? 0 : (size_ - 1) & ~pvec_mask;
+  }
+
+  static void release(pvec_node *n, unsigned level) {
+    if (!n || !n->drop()) {
+      return;
+    }
+    if (level == 0) {
+      delete static_cast<chunk *>(n);
+      return;
+    }
+    auto const inner = static_cast<pvec_inner *>(n);
+    for (auto const child : inner->children) {
+      release(child, level - pvec_bits);
+    }
+    delete inner;
+  }
+
+  /** The node if nothing else refers to it, else a copy to use instead. */
+  static auto own(chunk *c) -> chunk * {
+    if (c->unique()) {
+      return c;
+    }
+    auto const copy = new chunk(*c);
+    release(c, 0);
+    return copy;
+  }
+  static auto own(pvec_inner *n, unsigned level) -> pvec_inner * {
+    if (n->unique()) {
+      return n;
+    }
+    auto const copy = new pvec_inner;
+    for (std::size_t i = 0; i < pvec_width && n->children[i]; ++i) {
+      copy->children[i] = n->children[i];
+      copy->children[i]->retain();
+    }
+    release(n, level);
+    return copy;
+  }
+
+  /** Inner nodes above c up to level, each with one child. */
+  static auto new_path(unsigned level, pvec_node *c) -> pvec_node * {
+    auto n = c;
+    try {
+      for (auto l = pvec_bits; l <= level; l += pvec_bits) {
+        auto const parent = new pvec_inner;
+        parent->children[0] = n;
+        n = parent;
+      }
+    } catch (...) {
+      while (n != c) {
+        auto const parent = static_cast<pvec_inner *>(n);
+        n = parent->children[0];
+        delete parent;
+      }
+      throw;
+    }
+    return n;
+  }
+
+  /** Adds the full tail to the trie, which then also refers to it. */
+  void push_tail() {
+    auto const at = size_ - pvec_width;
+    tail_->retain();
+    try {
+      if (!root_) {
+        root_ = static_cast<pvec_inner *>(new_path(pvec_bits, tail_));
+      } else if ((at >> pvec_bits) == std::size_t{1} << shift_) {
+        // no room left under the root
+        auto const root = new pvec_inner;
+        try {
+          root->children[1] = new_path(shift_, tail_);
+        } catch (...) {
+          delete root;
+          throw;
+        }
+        root->children[0] = root_;
+        root_ = root;
+        shift_ += pvec_bits;
+      } else {
+        root_ = own(root_, shift_);
+        auto n = root_;
+        for (auto level = shift_;; level -= pvec_bits) {
+          auto &slot = n->children[(at >> level) & pvec_mask];
+          if (!slot) {
+            slot = new_path(level - pvec_bits, tail_);
+            return;
+          }
+          n = own(static_cast<pvec_inner *>(slot), level - pvec_bits);
+          slot = n;
+        }
+      }
+    } catch (...) {
+      tail_->drop();
+      throw;
+    }
+  }
+
+  /** Removes the trie's last chunk, which holds element at. */
+  void pop_tail(std::size_t at) {
+    root_ = own(root_, shift_);
+    if (!pop_chunk(root_, shift_, at)) {
+      release(root_, shift_);
+      root_ = nullptr;
+      shift_ = pvec_bits;
+    } else if (shift_ > pvec_bits && !root_->children[1]) {
+      auto const root = static_cast<pvec_inner *>(root_->children[0]);
+      root_->children[0] = nullptr;
+      release(root_, shift_);
+      root_ = root;
+      shift_ -= pvec_bits;
+    }
+  }
+  /** Removes the chunk holding element at under n; false if n is empty. */
+  static auto pop_chunk(pvec_inner *n, unsigned level, std::size_t at)
+      -> bool {
+    auto const i = (at >> level) & pvec_mask;
+    auto &slot = n->children[i];
+    if (level == pvec_bits) {
+      release(slot, 0);
+      slot = nullptr;
+    } else {
+      auto const child =
+          own(static_cast<pvec_inner *>(slot), level - pvec_bits);
+      slot = child;
+      if (!pop_chunk(child, level - pvec_bits, at)) {
+        release(child, level - pvec_bits);
+        slot = nullptr;
+      }
+    }
+    return i != 0 || slot != nullptr;
+  }
+
+  template <typename Fn>
+  static void visit(pvec_node const *n, unsigned level, Fn &fn) {
+    if (level == 0) {
+      auto const c = static_cast<chunk const *>(n);
+      fn(std::span<Any const>(c->values, c->count));
+      return;
+    }
+    for (auto const child : static_cast<pvec_inner const *>(n)->children) {
+      if (!child) {
+        return;
+      }
+      visit(child, level - pvec_bits, fn);
+    }
+  }
+};
+
+/** Walks a pvec_tree, looking up the next chunk every 32 elements. */
+template <typename Any>
+class pvec_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Any;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Any const *;
+  using reference = Any const &;
+
+  pvec_iterator() = default;
+  pvec_iterator(pvec_tree<Any> const &tree, std::size_t i)
+      : tree_{&tree}, i_{i},
+        chunk_{i < tree.size() ? tree.chunk_for(i)->values : nullptr} {}
+
+  auto operator*() const -> Any const & { return chunk_[i_ & pvec_mask]; }
+  auto operator->() const -> Any const * { return &**this; }
+  auto operator++() -> pvec_iterator & {
+    ++i_;
+    if ((i_ & pvec_mask) == 0 && i_ < tree_->size()) {
+      chunk_ = tree_->chunk_for(i_)->values;
+    }
+    return *this;
+  }
+  auto operator++(int) -> pvec_iterator {
+    auto const old = *this;
+    ++*this;
+    return old;
+  }
+  friend auto operator==(pvec_iterator const &x, pvec_iterator const &y)
+      -> bool {
+    return x.i_ == y.i_;
+  }
+
+private:
+  pvec_tree<Any> const *tree_ = nullptr;
+  std::size_t i_ = 0;
+  Any const *chunk_ = nullptr;
+};
+} // namespace detail
+
+template <typename Any>
+class transient_any_vector;
+
+template <typename Any>
+class persistent_any_vector {
+public:
+  using value_type = Any;
+  using size_type = std::size_t;
+  using const_iterator = detail::pvec_iterator<Any>;
+  using iterator = const_iterator;
+  /** Anys per chunk; every chunk but the last is full. */
+  static constexpr std::size_t chunk_size = detail::pvec_width;
+
+  persistent_any_vector() = default;
+
+  auto size() const -> std::size_t { return tree_.size(); }
+  auto empty() const -> bool { return tree_.size() == 0; }
+  auto operator[](std::size_t i) const -> Any const & {
+    assert(i < size());
+    return tree_[i];
+  }
+  auto begin() const -> const_iterator { return {tree_, 0}; }
+  auto end() const -> const_iterator { return {tree_, size()}; }
+
+  /** Calls fn with a std::span<Any const> of every chunk, in order. */
+  template <typename Fn>
+  void for_each_chunk(Fn &&fn) const {
+    tree_.for_each_chunk(fn);
+  }
+
+  /** This version with x appended. */
+  template <typename V>
+    requires std::constructible_from<Any, V>
+  auto push_back(V &&x) const & -> persistent_any_vector {
+    auto r = *this;
+    r.tree_.push_back(std::forward<V>(x));
+    return r;
+  }
+  template <typename V>
+    requires std::constructible_from<Any, V>
+  auto push_back(V &&x) && -> persistent_any_vector {
+    tree_.push_back(std::forward<V>(x));
+    return std::move(*this);
+  }
+
+  /** This version with element i replaced by x. */
+  template <typename V>
+    requires std::constructible_from<Any, V>
+  auto set(std::size_t i, V &&x) const & -> persistent_any_vector {
+    assert(i < size());
+    auto r = *this;
+    r.tree_.set(i, std::forward<V>(x));
+    return r;
+  }
+  template <typename V>
+    requires std::constructible_from<Any, V>
+  auto set(std::size_t i, V &&x) && -> persistent_any_vector {
+    assert(i < size());
+    tree_.set(i, std::forward<V>(x));
+    return std::move(*this);
+  }
+
+  /** This version without its last element. */
+  auto pop_back() const & -> persistent_any_vector {
+    auto r = *this;
+    r.tree_.pop_back();
+    return r;
+  }
+  auto pop_back() && -> persistent_any_vector {
+    tree_.pop_back();
+    return std::move(*this);
+  }
+
+  /** A transient to edit a copy of this version with. */
+  auto transient() const -> transient_any_vector<Any> {
+    return transient_any_vector<Any>(tree_);
+  }
+
+private:
+  friend class transient_any_vector<Any>;
+  detail::pvec_tree<Any> tree_;
+
+  explicit persistent_any_vector(detail::pvec_tree<Any> &&tree)
+      : tree_{std::move(tree)} {}
+};
+
+/** Edits a version in place where nothing else shares it. Not copyable. */
+template <typename Any>
+class transient_any_vector {
+public:
+  using value_type = Any;
+  using size_type = std::size_t;
+  using const_iterator = detail::pvec_iterator<Any>;
+  using iterator = const_iterator;
+
+  transient_any_vector() = default;
+  transient_any_vector(transient_any_vector &&) = default;
+  auto operator=(transient_any_vector &&) -> transient_any_vector & = default;
+
+  auto size() const -> std::size_t { return tree_.size(); }
+  auto empty() const -> bool { return tree_.size() == 0; }
+  auto operator[](std::size_t i) const -> Any const & {
+    assert(i < size());
+    return tree_[i];
+  }
+  auto begin() const -> const_iterator { return {tree_, 0}; }
+  auto end() const -> const_iterator { return {tree_, size()}; }
+
+  template <typename Fn>
+  void for_each_chunk(Fn &&fn) const {
+    tree_.for_each_chunk(fn);
+  }
+
+  template <typename V>
+    requires std::constructible_from<Any, V>
+  void push_back(V &&x) {
+    tree_.push_back(std::forward<V>(x));
+  }
+  template <typename V>
+    requires std::constructible_from<Any, V>
+  void set(std::size_t i, V &&x) {
+    assert(i < size());
+    tree_.set(i, std::forward<V>(x));
+  }
+  void pop_back() { tree_.pop_back(); }
+
+  /** The edited version; leaves the transient empty. */
+  auto persistent() && -> persistent_any_vector<Any> {
+    return persistent_any_vector<Any>(std::move(tree_));
+  }
+
+private:
+  friend class persistent_any_vector<Any>;
+  detail::pvec_tree<Any> tree_;
+
+  explicit transient_any_vector(detail::pvec_tree<Any> const &tree)
+      : tree_{tree} {}
+};
+
+} // namespace erasure
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file prefetch.hpp
+ * Traversal of anys that prefetches their models ahead of the visit.
+ *
+ * Calling a feature on an any whose model is on the heap waits for the model,
+ * then for the vtable it points to. for_each_prefetched(range, fn, distance)
+ * calls fn on every any of a random access range in order, and meanwhile
+ * prefetches the model `distance` elements ahead and the vtable of the model
+ * `distance / 2` elements ahead, whose model should have arrived by then.
+ *
+ * With auto_prefetch_distance, the first elements are visited in chunks with
+ * a few candidate distances, and the rest with the one that was fastest.
+ */
+
+#include "erasure.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+namespace erasure {
+
+/** Asks for_each_prefetched to pick the distance itself. */
+inline constexpr std::size_t auto_prefetch_distance = 0;
+
+namespace detail {
+inline void prefetch(void const *addr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(addr, 0, 3);
+#elif defined(_MSC_VER)
+  _mm_prefetch(static_cast<char const *>(addr), _MM_HINT_T0);
+#else
+  (void)addr;
+#endif
+}
+
+/** Prefetches x's model. A null address is fine: prefetches never fault. */
+template <typename Any>
+void prefetch_model(Any const &x) {
+  prefetch(buffer_ref(x).get());
+}
+/** Prefetches the vtable of x's model, which is read for it. */
+template <typename Any>
+void prefetch_vtable(Any const &x) {
+  if (auto const model = buffer_ref(x).get()) {
+    prefetch(vtable_word(model));
+  }
+}
+
+template <typename Iterator, typename Fn>
+void visit_prefetched(Iterator first, Iterator last, Iterator end, Fn &fn,
+                      std::size_t distance) {
+  auto const half = distance / 2;
+  for (; first != last; ++first) {
+    if (static_cast<std::size_t>(end - first) > distance) {
+      prefetch_model(first[distance]);
+    }
+    if (static_cast<std::size_t>(end - first) > half) {
+      prefetch_vtable(first[half]);
+    }
+    fn(*first);
+  }
+}
+
+/** The distances auto_prefetch_distance tries, and the elements per try. */
+inline constexpr std::array<std::size_t, 6> prefetch_candidates{2,  4,  8,
+                                                                16, 32, 64};
+inline constexpr std::size_t prefetch_tuning_chunk = 512;
+/** The distance used for ranges too short to tune on. */
+inline constexpr std::size_t default_prefetch_distance = 16;
+} // namespace detail
+
+/**
+ * Calls fn on every element of range, in order, prefetching the models and
+ * vtables of the ones ahead. Returns the distance it used.
+ */
+template <typename Range, typename Fn>
+auto for_each_prefetched(Range &&range, Fn fn,
+                         std::size_t distance = auto_prefetch_distance)
+    -> std::size_t {
+  auto first = std::begin(range);
+  auto const end = std::end(range);
+  static_assert(std::random_access_iterator<decltype(first)>,
+                "for_each_prefetched needs random access.");
+  auto const size = static_cast<std::size_t>(end - first);
+
+  if (distance == auto_prefetch_distance) {
+    constexpr auto chunk = detail::prefetch_tuning_chunk;
+    constexpr auto tries = detail::prefetch_candidates.size();
+    distance = detail::default_prefetch_distance;
+    // tune only where the tries are a small part of the traversal
+    if (size >= 4 * tries * chunk) {
+      using clock = std::chrono::steady_clock;
+      auto best = clock::duration::max();
+      for (auto const candidate : detail::prefetch_candidates) {
+        auto const start = clock::now();
+        detail::visit_prefetched(first, first + chunk, end, fn, candidate);
+        auto const elapsed = clock::now() - start;
+        if (elapsed < best) {
+          best = elapsed;
+          distance = candidate;
+        }
+        first += chunk;
+      }
+    }
+  }
+  detail::visit_prefetched(first, end, end, fn, distance);
+  return distance;
+}
+
+} // namespace erasure
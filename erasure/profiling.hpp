@@ -0,0 +1,255 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file profiling.hpp
+ * Call counters and sampled timings per (feature, dynamic value type), kept
+ * for the features of an any that are wrapped in `profiled<F>` (see
+ * feature/profiled.hpp).
+ *
+ * Only used when ERASURE_ENABLE_PROFILING is defined for the whole program.
+ *
+ * Every thread counts into its own counters, which only it writes; the
+ * counters of exited threads are folded into a global total. A call is one
+ * extra virtual call (to find the counters of the dynamic type) and one
+ * increment. Every sample_period()-th call is timed, with the time stamp
+ * counter on x86 and the steady clock elsewhere.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace erasure {
+namespace profiling {
+
+/** The feature that gives a model's counters; see feature/profiled.hpp. */
+template <typename Feature>
+struct probe;
+
+/** One thread's counts for one (feature, value type). */
+struct counters {
+  std::atomic<std::uint64_t> calls{0};
+  std::atomic<std::uint64_t> sampled_calls{0};
+  /** In ticks of the sampling clock; converted by snapshot(). */
+  std::atomic<std::uint64_t> sampled_ticks{0};
+  std::type_info const *feature = nullptr;
+  std::type_info const *value = nullptr;
+};
+
+/** The totals for one (feature, value type), see snapshot(). */
+struct call_site {
+  std::type_info const *feature;
+  std::type_info const *value;
+  std::uint64_t calls;
+  std::uint64_t sampled_calls;
+  std::uint64_t sampled_ns;
+
+  auto mean_ns() const -> double {
+    return sampled_calls ? static_cast<double>(sampled_ns) / sampled_calls : 0;
+  }
+};
+
+namespace detail {
+inline void bump(std::atomic<std::uint64_t> &x, std::uint64_t by) {
+  // only the owning thread writes, so no read-modify-write is needed
+  x.store(x.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+inline void add_to(std::vector<call_site> &sites, counters const &c) {
+  auto const calls = c.calls.load(std::memory_order_relaxed);
+  auto const sampled_calls = c.sampled_calls.load(std::memory_order_relaxed);
+  auto const sampled_ticks = c.sampled_ticks.load(std::memory_order_relaxed);
+  for (auto &site : sites) {
+    if (*site.feature == *c.feature && *site.value == *c.value) {
+      site.calls += calls;
+      site.sampled_calls += sampled_calls;
+      site.sampled_ns += sampled_ticks;
+      return;
+    }
+  }
+  sites.push_back({c.feature, c.value, calls, sampled_calls, sampled_ticks});
+}
+
+struct registry {
+  std::mutex mutex;
+  std::vector<counters *> live;
+  /** The totals of exited threads, in ticks until snapshot() converts them. */
+  std::vector<call_site> retired;
+};
+template <typename = void>
+registry registry_;
+
+/** Call n is timed if ((n + 1) & mask) == 0; by default 1 in 1024. */
+template <typename = void>
+std::atomic<std::uint64_t> sample_mask{1023};
+
+/** Retires the thread's counters when it exits. */
+struct thread_registration {
+  std::vector<counters *> mine;
+
+  ~thread_registration() {
+    auto &r = registry_<>;
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto c : mine) {
+      add_to(r.retired, *c);
+      r.live.erase(std::find(r.live.begin(), r.live.end(), c));
+    }
+  }
+};
+template <typename = void>
+thread_local thread_registration thread_registration_;
+
+[[gnu::noinline]] inline void register_counters(counters &c,
+                                                std::type_info const &feature,
+                                                std::type_info const &value) {
+  c.feature = &feature;
+  c.value = &value;
+  thread_registration_<>.mine.push_back(&c);
+  auto &r = registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.live.push_back(&c);
+}
+
+template <typename Feature, typename Value>
+thread_local counters counters_;
+
+template <typename Feature, typename Value>
+auto thread_counters() -> counters & {
+  auto &c = counters_<Feature, Value>;
+  if (c.feature == nullptr) [[unlikely]] {
+    register_counters(c, typeid(Feature), typeid(Value));
+  }
+  return c;
+}
+
+/** Ticks of the sampling clock: the TSC on x86, the steady clock elsewhere. */
+inline auto ticks() -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+inline auto steady_ns() -> std::uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** Pairs of (ticks, ns) taken when profiling started, to convert ticks. */
+struct epoch {
+  std::uint64_t ticks = detail::ticks();
+  std::uint64_t ns = steady_ns();
+};
+template <typename = void>
+epoch const epoch_;
+
+inline auto ns_per_tick() -> double {
+  auto const &start = epoch_<>;
+  auto const ns = steady_ns() - start.ns;
+  auto const ticks = detail::ticks() - start.ticks;
+  return ticks ? static_cast<double>(ns) / ticks : 1;
+}
+
+struct sample_timer {
+  explicit sample_timer(counters &c) : c(c), start(ticks()) {}
+  ~sample_timer() {
+    bump(c.sampled_ticks, ticks() - start);
+    bump(c.sampled_calls, 1);
+  }
+  counters &c;
+  std::uint64_t start;
+};
+
+template <typename F>
+[[gnu::noinline, gnu::cold]] auto sampled(counters &c, F &f)
+    -> decltype(auto) {
+  sample_timer timer{c};
+  return f();
+}
+
+/** Counts a call of f into c, and times it if it is sampled. */
+template <typename F>
+[[gnu::always_inline]] inline auto probed(counters &c, F &&f)
+    -> decltype(auto) {
+  auto const n = c.calls.load(std::memory_order_relaxed) + 1;
+  c.calls.store(n, std::memory_order_relaxed);
+  if ((n & sample_mask<>.load(std::memory_order_relaxed)) != 0) [[likely]] {
+    return f();
+  }
+  return sampled(c, f);
+}
+} // namespace detail
+
+/**
+ * Time every period-th call. The period is rounded up to a power of two; 0
+ * turns timing off.
+ */
+inline void set_sample_period(std::uint64_t period) {
+  std::uint64_t mask = ~std::uint64_t{0};
+  if (period != 0) {
+    mask = 0;
+    while (mask + 1 < period) {
+      mask = (mask << 1) | 1;
+    }
+  }
+  detail::sample_mask<>.store(mask, std::memory_order_relaxed);
+}
+inline auto sample_period() -> std::uint64_t {
+  auto const mask = detail::sample_mask<>.load(std::memory_order_relaxed);
+  return mask == ~std::uint64_t{0} ? 0 : mask + 1;
+}
+
+/**
+ * The totals of all threads, most called first. Counts of threads that are
+ * still calling may be slightly behind.
+ */
+inline auto snapshot() -> std::vector<call_site> {
+  auto &r = detail::registry_<>;
+  std::vector<call_site> sites;
+  {
+    std::lock_guard<std::mutex> lock(r.mutex);
+    sites = r.retired;
+    for (auto c : r.live) {
+      detail::add_to(sites, *c);
+    }
+  }
+  auto const scale = detail::ns_per_tick();
+  for (auto &site : sites) {
+    site.sampled_ns = static_cast<std::uint64_t>(site.sampled_ns * scale);
+  }
+  std::stable_sort(sites.begin(), sites.end(),
+                   [](call_site const &x, call_site const &y) {
+                     return x.calls > y.calls;
+                   });
+  return sites;
+}
+
+} // namespace profiling
+} // namespace erasure
@@ -16,13 +16,22 @@
 
 #pragma once
 
+#ifdef ERASURE_HOOKS
+#include "hooks.hpp"
+#endif
+#ifdef ERASURE_SPILL_TELEMETRY
+#include "telemetry.hpp"
+#endif
+
 #include <array>
 #include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <type_traits>
+#include <utility>
 
 namespace erasure {
 
@@ -54,6 +63,8 @@ struct buffer_t {
 struct buffer_spec {
   std::size_t size;
   std::size_t align;
+  /** Whether the model may be copied with memcpy. */
+  bool trivially_copyable = false;
 };
 
 template <typename T>
@@ -63,7 +74,29 @@ auto allocate() -> buffer_t {
   return {addr, sizeof(T)};
 }
 
-void deallocate(void *addr) { free(addr); }
+inline void deallocate(void *addr) {
+#ifdef ERASURE_HOOKS
+  hooks::notify_deallocated(addr);
+#endif
+  free(addr);
+}
+
+/**
+ * The start of a block of heap models placed together, which bulk.hpp makes
+ * and counts. Every model in it is preceded by a pointer to the block, and
+ * release_bulk gives one back through the block's unref.
+ */
+struct bulk_header {
+  void (*unref)(bulk_header *block);
+};
+
+/** Gives back the memory of a model placed in a bulk block. */
+inline void release_bulk(void *model) {
+  bulk_header *block;
+  std::memcpy(&block, static_cast<char *>(model) - sizeof(block),
+              sizeof(block));
+  block->unref(block);
+}
 
 /**
  * Get the next multiple of alignment.
@@ -79,7 +112,21 @@ auto align(void *buf_start) -> void * {
   }
 }
 
-template <std::size_t Size>
+/**
+ * Models that declare `static constexpr bool packable = true` need no
+ * destructor call.
+ */
+template <typename U>
+constexpr bool is_packable_v = requires { requires U::packable; };
+
+/**
+ * A pointer to the model, which lives in the buffer if it fits and on the
+ * heap otherwise.
+ *
+ * With Packed, the low bit of the pointer marks packable models that live in
+ * the buffer. Those are released without a destructor call.
+ */
+template <std::size_t Size, bool Packed = false>
 struct small_buffer {
   using buffer_type = std::array<char, Size>;
 
@@ -95,16 +142,29 @@ struct small_buffer {
 
   void reset() {
     if (!empty() && !is_internal()) {
-      ubuf::deallocate(ptr);
+      if (is_bulk()) {
+        release_bulk(get());
+      } else {
+        ubuf::deallocate(get());
+      }
     }
     ptr = nullptr;
   }
 
-  auto get() -> void * { return ptr; }
-  auto get() const -> void const * { return ptr; }
+  auto get() -> void * { return untagged(); }
+  auto get() const -> void const * { return untagged(); }
 
   auto empty() const -> bool { return ptr == nullptr; }
 
+  /** Whether the buffer holds a packable model. */
+  auto is_packed() const -> bool {
+    if constexpr (Packed) {
+      return ubuf::bit_cast<uintptr_t>(ptr) & packed_tag;
+    } else {
+      return false;
+    }
+  }
+
   template <typename U>
   auto allocate() -> buffer_t {
     assert(empty());
@@ -114,24 +174,56 @@ struct small_buffer {
     if (aligned_end <=
         ubuf::bit_cast<uintptr_t>(buf_end())) { // fits inside buffer_
       ptr = static_cast<void *>(aligned_start);
+      if constexpr (Packed && is_packable_v<U>) {
+        static_assert(alignof(U) > packed_tag, "The tag needs a free bit.");
+        ptr = ubuf::bit_cast<void *>(ubuf::bit_cast<uintptr_t>(ptr) |
+                                     packed_tag);
+      }
     } else {
       auto buf = ubuf::allocate<U>();
       ptr = buf.data;
     }
-    return {ptr, sizeof(U)};
+#ifdef ERASURE_HOOKS
+    hooks::notify_placed<U>(Size, !is_internal());
+#endif
+#ifdef ERASURE_SPILL_TELEMETRY
+    telemetry::detail::record<U, Size>(!is_internal());
+#endif
+    return {get(), sizeof(U)};
   };
 
   auto is_internal() const -> bool {
     assert(!empty());
-    auto const cptr = static_cast<char *>(ptr);
+    auto const cptr = static_cast<char const *>(get());
     return buf_start() <= cptr && cptr < buf_end();
   }
 
   operator bool() const { return !empty(); }
 
+  /** Gives up a heap-placed model (or nothing) without freeing it. */
+  auto release() -> owner<void *> {
+    assert(empty() || !is_internal());
+    auto const released = ptr;
+    ptr = nullptr;
+    return released;
+  }
+  /** Takes over a model released from a buffer of the same size. */
+  void adopt(owner<void *> heap_model) {
+    assert(empty());
+    ptr = heap_model;
+  }
+  /** Takes a model that was placed in a bulk_block. */
+  void adopt_bulk(void *model) {
+    assert(empty());
+    ptr = ubuf::bit_cast<void *>(ubuf::bit_cast<uintptr_t>(model) | bulk_tag);
+  }
+  /** Whether a model of type U never fits in the buffer. */
+  template <typename U>
+  static constexpr bool spills = sizeof(U) > Size;
+
   friend auto swap_if_not_internal(small_buffer &x, small_buffer &y) -> bool {
     using std::swap;
-    if (x.is_internal() || y.is_internal()) {
+    if ((x && x.is_internal()) || (y && y.is_internal())) {
       return false;
     }
     swap(x.ptr, y.ptr);
@@ -139,6 +231,19 @@ struct small_buffer {
   }
 
 private:
+  // models are aligned at least like their vtable pointer, so the low bits
+  // of ptr are free
+  static constexpr uintptr_t packed_tag = 1;
+  static constexpr uintptr_t bulk_tag = 2;
+
+  auto is_bulk() const -> bool {
+    return ubuf::bit_cast<uintptr_t>(ptr) & bulk_tag;
+  }
+  auto untagged() const -> void * {
+    return ubuf::bit_cast<void *>(ubuf::bit_cast<uintptr_t>(ptr) &
+                                  ~(packed_tag | bulk_tag));
+  }
+
   auto buf_start() -> char * { return buffer_.data(); }
   auto buf_end() -> char * { return buffer_.data() + buffer_.size(); }
   auto buf_start() const -> char const * { return buffer_.data(); }
@@ -150,8 +255,9 @@ private:
   buffer_type buffer_;
 };
 
-template <>
-struct small_buffer<0> {
+/** With no buffer, every model is on the heap and nothing is packed. */
+template <bool Packed>
+struct small_buffer<0, Packed> {
   using buffer_type = std::array<char, 0>;
 
   small_buffer() : ptr{nullptr} {}
@@ -167,20 +273,32 @@ struct small_buffer<0> {
 
   void reset() {
     if (!empty()) {
-      ubuf::deallocate(ptr);
+      if (is_bulk()) {
+        release_bulk(get());
+      } else {
+        ubuf::deallocate(get());
+      }
     }
     ptr = nullptr;
   }
 
-  auto get() -> void * { return ptr; }
-  auto get() const -> void * { return ptr; }
+  auto get() -> void * { return untagged(); }
+  auto get() const -> void * { return untagged(); }
 
   auto empty() const -> bool { return ptr == nullptr; }
 
+  auto is_packed() const -> bool { return false; }
+
   template <typename U>
   auto allocate() -> buffer_t {
     auto buf = ubuf::allocate<U>();
     ptr = buf.data;
+#ifdef ERASURE_HOOKS
+    hooks::notify_placed<U>(0, true);
+#endif
+#ifdef ERASURE_SPILL_TELEMETRY
+    telemetry::detail::record<U, 0>(true);
+#endif
     return buf;
   }
 
@@ -189,6 +307,22 @@ struct small_buffer<0> {
     return false;
   }
 
+  auto release() -> owner<void *> {
+    auto const released = ptr;
+    ptr = nullptr;
+    return released;
+  }
+  void adopt(owner<void *> heap_model) {
+    assert(empty());
+    ptr = heap_model;
+  }
+  void adopt_bulk(void *model) {
+    assert(empty());
+    ptr = ubuf::bit_cast<void *>(ubuf::bit_cast<uintptr_t>(model) | bulk_tag);
+  }
+  template <typename U>
+  static constexpr bool spills = true;
+
   friend auto swap_if_not_internal(small_buffer &x, small_buffer &y) -> bool {
     using std::swap;
     swap(x.ptr, y.ptr);
@@ -198,6 +332,15 @@ struct small_buffer<0> {
   operator bool() const { return !empty(); }
 
 private:
+  static constexpr uintptr_t bulk_tag = 2;
+
+  auto is_bulk() const -> bool {
+    return ubuf::bit_cast<uintptr_t>(ptr) & bulk_tag;
+  }
+  auto untagged() const -> void * {
+    return ubuf::bit_cast<void *>(ubuf::bit_cast<uintptr_t>(ptr) & ~bulk_tag);
+  }
+
   owner<void *> ptr;
 };
 
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file telemetry.hpp
+ * Spill telemetry: how often each (any type, value type) is placed into its
+ * small buffer and how often it spills to the heap.
+ *
+ * Recorded by small_buffer::allocate when ERASURE_SPILL_TELEMETRY is defined
+ * for the whole program. Every thread counts the placements of every model
+ * type in its own counters, so a placement is a thread-local increment and a
+ * (predicted) check whether the counters are registered yet, with no
+ * contention between threads: cheap enough for canary builds. The counts of
+ * exited threads are folded into their sites.
+ *
+ * report() reads the counters at any time; debug/spill_report.hpp prints
+ * them, also at exit.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+namespace erasure {
+namespace telemetry {
+
+/**
+ * The any and value type a model type stands for. erasure.hpp specializes it
+ * for its models; anything else is reported as its own value type.
+ */
+template <typename Model>
+struct model_identity {
+  using any_type = void;
+  using value_type = Model;
+};
+
+/** One model type in one buffer size. */
+struct site {
+  std::type_info const &any_type;
+  std::type_info const &value_type;
+  std::size_t model_size;
+  std::size_t model_align;
+  /** The small buffer's size. */
+  std::size_t capacity;
+  /** The placements of exited threads. */
+  std::atomic<std::uint64_t> retired_inline{0};
+  std::atomic<std::uint64_t> retired_heap{0};
+  std::atomic<bool> registered{false};
+  site *next = nullptr;
+};
+
+/** One thread's placements of one site; only that thread writes them. */
+struct thread_counts {
+  std::atomic<std::uint64_t> inline_placements{0};
+  std::atomic<std::uint64_t> heap_placements{0};
+  site *of = nullptr;
+};
+
+/** A snapshot of one site. */
+struct site_report {
+  std::type_info const *any_type;
+  std::type_info const *value_type;
+  std::size_t model_size;
+  std::size_t model_align;
+  std::size_t capacity;
+  std::uint64_t inline_placements;
+  std::uint64_t heap_placements;
+
+  /** How many bytes the buffer is short of holding the model (0 if none). */
+  auto missing_bytes() const -> std::size_t {
+    return model_size > capacity ? model_size - capacity : 0;
+  }
+};
+
+/** Placements of models of sizes in (previous bucket's upper, upper]. */
+struct size_bucket {
+  std::size_t upper;
+  std::uint64_t inline_placements;
+  std::uint64_t heap_placements;
+};
+
+namespace detail {
+inline void bump(std::atomic<std::uint64_t> &x) {
+  x.store(x.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+template <typename = void>
+std::atomic<site *> sites{nullptr};
+
+struct registry {
+  std::mutex mutex;
+  std::vector<thread_counts *> live;
+};
+template <typename = void>
+registry registry_;
+
+/** Retires the thread's counts into their sites when it exits. */
+struct thread_registration {
+  std::vector<thread_counts *> mine;
+
+  ~thread_registration() {
+    auto &r = registry_<>;
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto c : mine) {
+      c->of->retired_inline.fetch_add(c->inline_placements.load());
+      c->of->retired_heap.fetch_add(c->heap_placements.load());
+      r.live.erase(std::find(r.live.begin(), r.live.end(), c));
+    }
+  }
+};
+template <typename = void>
+thread_local thread_registration thread_registration_;
+
+[[gnu::noinline]] inline void register_counts(thread_counts &c, site &s) {
+  c.of = &s;
+  thread_registration_<>.mine.push_back(&c);
+  auto &r = registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.live.push_back(&c);
+  if (!s.registered.exchange(true)) {
+    s.next = sites<>.load(std::memory_order_relaxed);
+    sites<>.store(&s, std::memory_order_release);
+  }
+}
+
+template <typename Model, std::size_t Capacity>
+site site_{typeid(typename model_identity<Model>::any_type),
+           typeid(typename model_identity<Model>::value_type),
+           sizeof(Model),
+           alignof(Model),
+           Capacity};
+
+template <typename Model, std::size_t Capacity>
+thread_local thread_counts thread_counts_;
+
+template <typename Model, std::size_t Capacity>
+void record(bool on_heap) {
+  auto &c = thread_counts_<Model, Capacity>;
+  bump(on_heap ? c.heap_placements : c.inline_placements);
+  if (c.of == nullptr) [[unlikely]] {
+    register_counts(c, site_<Model, Capacity>);
+  }
+}
+} // namespace detail
+
+/** All sites with placements, the ones spilling most first. */
+inline auto report() -> std::vector<site_report> {
+  std::vector<site_report> result;
+  std::vector<site const *> of;
+  auto &r = detail::registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto s = detail::sites<>.load(std::memory_order_acquire); s;
+       s = s->next) {
+    result.push_back({&s->any_type, &s->value_type, s->model_size,
+                      s->model_align, s->capacity, s->retired_inline.load(),
+                      s->retired_heap.load()});
+    of.push_back(s);
+  }
+  for (auto c : r.live) {
+    auto &x = result[std::find(of.begin(), of.end(), c->of) - of.begin()];
+    x.inline_placements += c->inline_placements.load(std::memory_order_relaxed);
+    x.heap_placements += c->heap_placements.load(std::memory_order_relaxed);
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](site_report const &x, site_report const &y) {
+                     return x.heap_placements > y.heap_placements;
+                   });
+  return result;
+}
+
+/** Placements by model size, in power-of-two buckets from 8 bytes up. */
+inline auto size_histogram(std::vector<site_report> const &sites = report())
+    -> std::vector<size_bucket> {
+  std::vector<size_bucket> buckets;
+  for (auto const &s : sites) {
+    std::size_t upper = 8;
+    std::size_t i = 0;
+    while (upper < s.model_size) {
+      upper *= 2;
+      ++i;
+    }
+    while (buckets.size() <= i) {
+      buckets.push_back({std::size_t{8} << buckets.size(), 0, 0});
+    }
+    buckets[i].inline_placements += s.inline_placements;
+    buckets[i].heap_placements += s.heap_placements;
+  }
+  return buckets;
+}
+
+/**
+ * Zeroes all counters. Placements that other threads make meanwhile may be
+ * lost.
+ */
+inline void reset() {
+  auto &r = detail::registry_<>;
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto s = detail::sites<>.load(std::memory_order_acquire); s;
+       s = s->next) {
+    s->retired_inline.store(0);
+    s->retired_heap.store(0);
+  }
+  for (auto c : r.live) {
+    c->inline_placements.store(0, std::memory_order_relaxed);
+    c->heap_placements.store(0, std::memory_order_relaxed);
+  }
+}
+
+} // namespace telemetry
+} // namespace erasure
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file type_hash.hpp
+ * A type identity that holds across shared objects.
+ *
+ * type_hash<T>() is the 64-bit FNV-1a hash of the compiler's name for T,
+ * computed at compile time. It is the same in every shared object built by
+ * the same compiler, where vtable addresses and type_info objects may differ
+ * (with hidden visibility or RTLD_LOCAL, for instance), so it identifies the
+ * value types of anys made in one shared object and used in another. Within
+ * one shared object, typeid stays the authority; the hash is only asked when
+ * the type_infos differ.
+ *
+ * Only types with external linkage have one: the name of a closure, a local
+ * class or a type in an unnamed namespace may be the same for different
+ * types (two lambdas in one function, say), so has_type_hash<T> is false for
+ * them and type_hash<T>() does not compile. With ERASURE_CHECK_TYPE_HASHES
+ * defined, checked_type_hash<T>() remembers the name behind every hash it
+ * gives out and aborts, naming both types, if two names hash alike.
+ */
+
+#include <cstdint>
+#include <string_view>
+
+#ifdef ERASURE_CHECK_TYPE_HASHES
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#endif
+
+namespace erasure {
+namespace detail {
+template <typename T>
+constexpr auto type_name_signature() -> std::string_view {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+} // namespace detail
+
+/** The compiler's name for T, e.g. "int" or "std::vector<int>". */
+template <typename T>
+constexpr auto type_name() -> std::string_view {
+  constexpr auto signature = detail::type_name_signature<T>();
+#if defined(_MSC_VER) && !defined(__clang__)
+  // ... type_name_signature<int>(void)
+  constexpr auto first = signature.find("type_name_signature<") + 20;
+  constexpr auto last = signature.rfind(">(void)");
+#else
+  // ... [T = int] for Clang, ... [with T = int; std::string_view = ...] for
+  // GCC
+  constexpr auto first = signature.find("T = ") + 4;
+  constexpr auto alias = signature.find("; std::string_view", first);
+  constexpr auto last = alias < signature.size() ? alias : signature.rfind(']');
+#endif
+  return signature.substr(first, last - first);
+}
+
+namespace detail {
+/** If the name is the same in every shared object, and for no other type. */
+constexpr auto is_portable_type_name(std::string_view name) -> bool {
+  // closures, unnamed types and local classes, as GCC, Clang and MSVC spell
+  // them
+  constexpr std::string_view no_linkage[] = {
+      "<lambda",    "(lambda",    "`lambda",  "{anonymous}",
+      "(anonymous", "`anonymous", "<unnamed", "(unnamed",
+      "{unnamed type", ")::", "'::"};
+  for (auto const part : no_linkage) {
+    if (name.find(part) != std::string_view::npos) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace detail
+
+/** If T has external linkage, and so a type_hash. */
+template <typename T>
+inline constexpr bool has_type_hash =
+    detail::is_portable_type_name(type_name<T>());
+
+/** The FNV-1a hash of type_name<T>(). */
+template <typename T>
+constexpr auto type_hash() -> std::uint64_t {
+  static_assert(has_type_hash<T>,
+                "closures, local classes and types in unnamed namespaces "
+                "have no type_hash");
+  std::uint64_t h = 0xcbf29ce484222325u;
+  for (auto const c : type_name<T>()) {
+    h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3u;
+  }
+  return h;
+}
+
+namespace detail {
+#ifdef ERASURE_CHECK_TYPE_HASHES
+/** Remembers that name hashes to hash, and aborts if another name did. */
+inline auto register_type_hash(std::uint64_t hash, std::string_view name)
+    -> bool {
+  static std::mutex mutex;
+  static std::unordered_map<std::uint64_t, std::string_view> names;
+  std::lock_guard lock(mutex);
+  auto const [seen, inserted] = names.emplace(hash, name);
+  if (!inserted && seen->second != name) {
+    std::fprintf(stderr, "erasure: %.*s and %.*s have the same type_hash\n",
+                 static_cast<int>(seen->second.size()), seen->second.data(),
+                 static_cast<int>(name.size()), name.data());
+    std::abort();
+  }
+  return true;
+}
+#endif
+
+/**
+ * type_hash<T>(), checked for collisions with ERASURE_CHECK_TYPE_HASHES, or 0
+ * if T has none.
+ */
+template <typename T>
+auto checked_type_hash() -> std::uint64_t {
+  if constexpr (has_type_hash<T>) {
+    constexpr auto hash = type_hash<T>();
+#ifdef ERASURE_CHECK_TYPE_HASHES
+    static bool const registered = register_type_hash(hash, type_name<T>());
+    (void)registered;
+#endif
+    return hash;
+  } else {
+    return 0;
+  }
+}
+} // namespace detail
+} // namespace erasure
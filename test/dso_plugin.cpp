@@ -0,0 +1,44 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dso_plugin.hpp"
+
+using dso_test::point;
+using dso_test::value;
+
+DSO_TEST_EXPORT void dso_test_make(std::vector<value> &out, int x) {
+  out.emplace_back(point{x, 2});
+  out.emplace_back(std::string(40, 'p'));
+  out.emplace_back(7);
+}
+
+DSO_TEST_EXPORT bool dso_test_check(std::vector<value> const &theirs,
+                                    int their_x) {
+  std::vector<value> ours;
+  dso_test_make(ours, their_x);
+  if (theirs.size() != ours.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < ours.size(); ++i) {
+    if (!same_dynamic_type(theirs[i], ours[i]) || !(theirs[i] == ours[i])) {
+      return false;
+    }
+  }
+  auto const p = erasure::target<point>(theirs[0]);
+  return p && *p == point{their_x, 2} &&
+         erasure::target<std::string>(theirs[1]) &&
+         !erasure::target<int>(theirs[1]);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/**
+ * @file dso_plugin.hpp
+ * What test_dso and the two plugins it loads with dlopen agree on.
+ *
+ * The plugins are built with hidden visibility and loaded with RTLD_LOCAL,
+ * so each has its own vtables and type_info objects for the same types.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dso_test {
+
+struct point {
+  int x, y;
+  friend auto operator==(point const &, point const &) -> bool = default;
+};
+
+using value = erasure::any<erasure::features::regular>;
+
+/** Appends point{x, 2}, std::string(40, 'p') and 7 to out. */
+using make_fn = void(std::vector<value> &out, int x);
+/**
+ * If the plugin recognizes what the other plugin made: the types by
+ * target<T> and same_dynamic_type, and the values by ==.
+ */
+using check_fn = bool(std::vector<value> const &theirs, int their_x);
+
+} // namespace dso_test
+
+#define DSO_TEST_EXPORT extern "C" __attribute__((visibility("default")))
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+DBG_UTIL_COUNT_OPERATOR_NEW()
+
+int main() {
+  using erasure::any;
+  using erasure::features::buffer_size;
+  using erasure::features::function;
+  using erasure::features::regular;
+
+  using dbg_util::instrumented;
+
+  using inline_any = any<regular, buffer_size<16>>;
+  using spilling_any = any<regular>;
+
+  // inline models never touch the heap
+  {
+    ASSERT_ALLOCATIONS(0, inline_any{5});
+    inline_any x = 5;
+    inline_any y;
+    ASSERT_ALLOCATIONS(0, y = x);
+    ASSERT_ALLOCATIONS(0, y = std::move(x));
+    ASSERT_DEALLOCATIONS(0, y = inline_any{});
+  }
+
+  // every copy of a spilled model is one allocation
+  {
+    ASSERT_ALLOCATIONS(1, spilling_any{5});
+    spilling_any x = 5;
+    spilling_any y, z;
+    ASSERT_ALLOCATIONS(1, y = x);
+    ASSERT_ALLOCATIONS(1, z = y);
+    ASSERT_DEALLOCATIONS(1, y = spilling_any{});
+    // the models are malloc'd, not new'd
+    ASSERT_OPERATOR_NEWS(0, y = z);
+    // ... but copying the value may still new
+    spilling_any s = std::string(64, 'x');
+    ASSERT_ALLOCATIONS(1, spilling_any{s});
+    ASSERT_OPERATOR_NEWS(1, spilling_any{s});
+    // assigning between equal types assigns the values, in place
+    ASSERT_ALLOCATIONS(1, y = s);
+    ASSERT_ALLOCATIONS(0, y = s);
+    ASSERT_DISPATCHES(1, y = s);
+  }
+
+  // calls neither allocate nor do anything but the one dispatch
+  {
+    int offset = 1;
+    any<function<int(int)>> f = [offset](int x) { return x + offset; };
+    int r = 0;
+    ASSERT_ALLOCATIONS(0, r = f(1));
+    ASSERT_DISPATCHES(1, r = f(r));
+    ASSERT_OPERATOR_NEWS(0, r = f(r));
+    (void)r;
+
+    inline_any x = 5;
+    inline_any y = 5;
+    bool equal = false;
+    ASSERT_ALLOCATIONS(0, equal = x == y);
+    (void)equal;
+  }
+
+  // operations on the value: a copy is one copy construction
+  {
+    dbg_util::clear_trace();
+    inline_any x = instrumented<int>{5};
+    spilling_any y = instrumented<int>{5};
+    inline_any x2;
+    spilling_any y2;
+    ASSERT_OPERATIONS(1, x2 = x);
+    ASSERT_OPERATIONS(1, y2 = y);
+    ASSERT_OPERATIONS(1, x2 = inline_any{});
+  }
+
+  // swapping hands over heap models and relocates inline ones, never
+  // allocating
+  {
+    using swap_any =
+        any<regular, erasure::features::swappable, buffer_size<24>>;
+    swap_any a = instrumented<int>{5};
+    swap_any b = instrumented<short>{6};
+    swap_any heap = std::string(64, 'x');
+    swap_any other_heap = std::vector<int>(16, 1);
+    swap_any none;
+
+    // heap and heap: the pointers change places
+    ASSERT_ALLOCATIONS(0, swap(heap, other_heap));
+    ASSERT_DEALLOCATIONS(0, swap(heap, other_heap));
+    ASSERT_DISPATCHES(0, swap(heap, other_heap));
+    assert(erasure::target<std::vector<int>>(heap) != nullptr);
+    // inline and heap: one relocation, i.e. a move and a destruction
+    ASSERT_ALLOCATIONS(0, swap(a, heap));
+    ASSERT_OPERATIONS(2, swap(heap, a));
+    assert(erasure::target<instrumented<int>>(a) != nullptr);
+    assert(erasure::target<std::vector<int>>(heap) != nullptr);
+    // inline and inline: three relocations through a stack buffer
+    ASSERT_ALLOCATIONS(0, swap(a, b));
+    ASSERT_OPERATIONS(6, swap(a, b));
+    assert(erasure::target<instrumented<int>>(a) != nullptr);
+    assert(erasure::target<instrumented<short>>(b) != nullptr);
+    // an empty any is handed over like a heap one
+    ASSERT_OPERATIONS(2, swap(a, none));
+    ASSERT_ALLOCATIONS(0, swap(none, heap));
+    assert(empty(a));
+    assert(erasure::target<instrumented<int>>(heap) != nullptr);
+    assert(erasure::target<std::vector<int>>(none) != nullptr);
+    // equal types swap the values in place
+    swap_any c = instrumented<int>{7};
+    ASSERT_OPERATIONS(1, swap(heap, c));
+    ASSERT_DISPATCHES(1, swap(heap, c));
+  }
+
+  // an any returned by an erased call is made in the caller's result: the
+  // value is constructed once, in place, and destroyed with the result
+  {
+    using result = any<regular, buffer_size<24>>;
+    any<function<result(int)>> make = [](int x) {
+      return instrumented<int>{x};
+    };
+    ASSERT_ALLOCATIONS(0, (void)make(1));
+    ASSERT_DISPATCHES(2, (void)make(1));
+    ASSERT_OPERATIONS(2, (void)make(1));
+    assert(*erasure::target<instrumented<int>>(make(3)) == instrumented<int>{3});
+  }
+
+  // packed scalars are destroyed without a call, in a handle of usual size
+  {
+    using erasure::features::pack_scalars;
+    using erasure::features::swappable;
+    using packed_any = any<regular, swappable, pack_scalars, buffer_size<16>>;
+    static_assert(sizeof(any<regular, pack_scalars>) == sizeof(any<regular>));
+    static_assert(sizeof(packed_any) ==
+                  sizeof(any<regular, swappable, buffer_size<16>>));
+    static_assert(sizeof(packed_any) == sizeof(void *) + 16);
+    packed_any i = 42;
+    packed_any d = 2.5;
+    packed_any s = std::string(64, 'x');
+    packed_any x, y;
+    ASSERT_ALLOCATIONS(0, packed_any{std::int64_t{7}});
+    ASSERT_ALLOCATIONS(0, x = i);
+    ASSERT_ALLOCATIONS(0, y = std::move(x));
+    ASSERT_ALLOCATIONS(0, x = d);
+    ASSERT_ALLOCATIONS(0, swap(x, y));
+    ASSERT_ALLOCATIONS(0, swap(y, i));
+    ASSERT_ALLOCATIONS(0, swap(x, y));
+    ASSERT_DISPATCHES(0, x = packed_any{});
+    assert(*erasure::target<int>(y) == 42);
+    assert(*erasure::target<double>(i) == 2.5);
+    ASSERT_DISPATCHES(1, (void)(y == packed_any{42}));
+    assert(y == packed_any{42} && y != packed_any{43} && y != i);
+    // values that are not trivially destructible take the usual path
+    ASSERT_ALLOCATIONS(1, x = s);
+    ASSERT_ALLOCATIONS(0, x = y);
+    assert(*erasure::target<int>(x) == 42);
+  }
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/arena.hpp"
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <cassert>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+namespace features = erasure::features;
+using value = erasure::any<features::regular>;
+using handle = erasure::arena_any<value>;
+
+static_assert(sizeof(handle) == 4);
+
+void test_values_round_trip() {
+  erasure::arena<value> a(1 << 16);
+  auto const i = a.emplace(42);
+  auto const s = a.emplace(std::string(100, 's'));
+  auto const none = a.insert(value{});
+  assert(*a.target<int>(i) == 42);
+  assert(a.target<std::string>(i) == nullptr);
+  assert(a.target<std::string>(s)->size() == 100);
+  assert(!none && a.concept_ptr(none) == nullptr);
+
+  // the features are called through the arena
+  auto const j = a.insert(value{42});
+  assert(a.same_dynamic_type(i, j) && !a.same_dynamic_type(i, s));
+  assert(a.call<features::equality_comparable>(i, *a.concept_ptr(j)));
+  auto const k = a.emplace(7);
+  a.call<features::copy_assignable>(k, *a.concept_ptr(i));
+  assert(*a.target<int>(k) == 42);
+
+  // ... or on a full any, copied out
+  assert(a.get(i) == value{42});
+  assert(a.get(s) == value{std::string(100, 's')});
+  assert(empty(a.get(none)));
+
+  // a moved-in any keeps its moved-from value
+  value moved = std::string(100, 'm');
+  auto const m = a.insert(std::move(moved));
+  assert(*a.target<std::string>(m) == std::string(100, 'm'));
+  assert(erasure::target<std::string>(moved)->empty());
+
+  // models are copied between arenas
+  erasure::arena<value> b(1 << 16);
+  auto const copied = b.insert(a, s);
+  assert(b.get(copied) == a.get(s));
+}
+
+void test_no_allocations() {
+  erasure::arena<value> a(1 << 16);
+  ASSERT_ALLOCATIONS(0, a.emplace(1));
+  value const d = 2.5;
+  ASSERT_ALLOCATIONS(0, a.insert(d));
+  // an int model is a vtable pointer and the int, rounded to 16 bytes
+  assert(a.size_bytes() == 32);
+}
+
+void test_clear_destroys_models() {
+  erasure::arena<value> a(1 << 16);
+  std::vector<handle> handles;
+  for (int i = 0; i < 100; ++i) {
+    handles.push_back(a.emplace(std::string(64, 'x')));
+  }
+  // one destructor call per model
+  ASSERT_DISPATCHES(100, a.clear());
+  assert(a.size_bytes() == 0);
+}
+
+void test_capacity() {
+  erasure::arena<value> a(64);
+  a.emplace(1);
+  a.emplace(2);
+  a.emplace(3);
+  auto thrown = false;
+  try {
+    a.emplace(4);
+  } catch (std::bad_alloc const &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // 32-bit handles name at most max_capacity bytes
+  thrown = false;
+  try {
+    erasure::arena<value> too_big(erasure::arena<value>::max_capacity + 1);
+  } catch (std::length_error const &) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+struct throws_on_copy {
+  throws_on_copy() = default;
+  throws_on_copy(throws_on_copy const &) { throw 1; }
+  throws_on_copy(throws_on_copy &&) = default;
+  auto operator=(throws_on_copy const &) -> throws_on_copy & = default;
+  auto operator=(throws_on_copy &&) -> throws_on_copy & = default;
+  friend auto operator==(throws_on_copy const &, throws_on_copy const &)
+      -> bool = default;
+};
+
+void test_throwing_construction() {
+  erasure::arena<value> a(1 << 16);
+  a.emplace(1);
+  auto const before = a.size_bytes();
+  throws_on_copy const x;
+  auto thrown = false;
+  try {
+    a.emplace(x);
+  } catch (int) {
+    thrown = true;
+  }
+  assert(thrown && a.size_bytes() == before);
+  value const y = throws_on_copy{};
+  thrown = false;
+  try {
+    a.insert(y);
+  } catch (int) {
+    thrown = true;
+  }
+  assert(thrown && a.size_bytes() == before);
+  // the next model takes the space back, and clear() destroys only real ones
+  auto const i = a.emplace(2);
+  assert(*a.target<int>(i) == 2 && a.size_bytes() == 2 * before);
+  ASSERT_DISPATCHES(2, a.clear());
+}
+} // namespace
+
+int main() {
+  test_values_round_trip();
+  test_no_allocations();
+  test_clear_destroys_models();
+  test_capacity();
+  test_throwing_construction();
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/buffer_advisor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using widget_any = erasure::any<erasure::features::regular,
+                                erasure::features::buffer_size<8>>;
+using other_any = erasure::any<erasure::features::movable>;
+
+template <std::size_t N>
+struct bytes {
+  std::array<char, N> data{};
+  friend auto operator==(bytes const &x, bytes const &y) -> bool {
+    return x.data == y.data;
+  }
+};
+
+auto entry(std::size_t model_size, std::uint64_t placements)
+    -> dbg_util::profile_entry {
+  return {"", "any", "value", model_size, 8, 0, 0, placements};
+}
+} // namespace
+
+int main() {
+  // a profile round-trips through its file format
+  std::vector<dbg_util::profile_entry> entries;
+  {
+    dbg_util::name_any<widget_any>("widget_any");
+    std::vector<widget_any> widgets;
+    widgets.reserve(11);
+    for (int i = 0; i < 10; ++i) {
+      widgets.emplace_back(bytes<24>{});
+    }
+    widgets.emplace_back(bytes<100>{});
+    other_any o = 1;
+
+    std::stringstream profile;
+    dbg_util::write_spill_profile(profile);
+    assert(dbg_util::read_spill_profile(profile, entries));
+    assert(entries.size() == 3);
+    auto const widgets_of_24 =
+        std::find_if(entries.begin(), entries.end(), [](auto const &e) {
+          return e.value_type.find("bytes<24") != std::string::npos;
+        });
+    assert(widgets_of_24 != entries.end());
+    assert(widgets_of_24->name == "widget_any");
+    assert(widgets_of_24->model_size == sizeof(void *) + 24);
+    assert(widgets_of_24->capacity == 8);
+    assert(widgets_of_24->heap_placements == 10);
+
+    std::istringstream garbage("not a profile\n");
+    assert(!dbg_util::read_spill_profile(garbage, entries));
+
+    // a corrupt line stops the reading, keeping the lines before it
+    std::vector<dbg_util::profile_entry> partial;
+    std::istringstream corrupt(std::string(dbg_util::spill_profile_header) +
+                               "\n-\tany\tint\t16\t8\t8\t3\t0\n"
+                               "-\tany\tlong\t16\tx\t8\t3\t0\n"
+                               "-\tany\tchar\t16\t8\t8\t3\t0\n");
+    assert(!dbg_util::read_spill_profile(corrupt, partial));
+    assert(partial.size() == 1 && partial[0].value_type == "int");
+    std::istringstream overflow(
+        std::string(dbg_util::spill_profile_header) +
+        "\n-\tany\tint\t16\t8\t8\t99999999999999999999999\t0\n");
+    assert(!dbg_util::read_spill_profile(overflow, partial));
+  }
+
+  // the advice: ten 32 byte models fit a 32 byte buffer, the one 108 byte
+  // model spills; the unnamed any holds only 16 byte models
+  {
+    auto const advice = dbg_util::advise_buffer_sizes(entries, 64);
+    assert(advice.size() == 2);
+    for (auto const &a : advice) {
+      if (a.name == "widget_any") {
+        assert(a.placements == 11);
+        assert(a.capacity == 8);
+        assert(a.heap_placements == 11);
+        assert(a.advised_capacity == 32);
+        assert(a.advised_heap_placements == 1);
+        assert(a.advised_cost < a.cost);
+      } else {
+        assert(a.name.empty());
+        assert(a.advised_capacity == 16);
+      }
+    }
+
+    std::ostringstream header;
+    dbg_util::write_buffer_size_header(header, advice, "buffer_sizes", 64);
+    assert(header.str().find("namespace buffer_sizes {") != std::string::npos);
+    assert(header.str().find(
+               "using widget_any = erasure::buffer_size<32>;") !=
+           std::string::npos);
+  }
+
+  // the weight trades handle bytes against allocations
+  {
+    std::vector<dbg_util::profile_entry> const mixed{entry(16, 90),
+                                                     entry(64, 10)};
+    // growing to 64 costs 90 * 48 handle bytes to save 10 allocations
+    assert(dbg_util::advise_buffer_sizes(mixed, 64)[0].advised_capacity ==
+           16);
+    assert(dbg_util::advise_buffer_sizes(mixed, 1000)[0].advised_capacity ==
+           64);
+    // without allocation costs, the smallest handle wins
+    assert(dbg_util::advise_buffer_sizes(mixed, 0)[0].advised_capacity == 0);
+  }
+}
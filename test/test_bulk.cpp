@@ -0,0 +1,109 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/bulk.hpp"
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <array>
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace {
+namespace features = erasure::features;
+using features::buffer_size;
+using features::regular;
+using features::swappable;
+
+struct big {
+  std::array<int, 8> xs;
+  friend auto operator==(big const &, big const &) -> bool = default;
+};
+
+void test_make_anys() {
+  using value = erasure::any<regular, swappable, buffer_size<16>>;
+  std::vector<std::string> strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::string(40, 'a' + i % 26));
+  }
+  auto const make = [&] {
+    return erasure::make_anys<regular, swappable, buffer_size<16>>(
+        strings.begin(), strings.end());
+  };
+  std::vector<value> xs, ys;
+  // all models in one block, without calls through the vtable
+  ASSERT_ALLOCATIONS(1, xs = make());
+  ASSERT_DISPATCHES(0, ys = make());
+  ASSERT_DEALLOCATIONS(1, ys.clear());
+  assert(xs.size() == 100);
+  for (int i = 0; i < 100; ++i) {
+    assert(*erasure::target<std::string>(xs[i]) == strings[i]);
+  }
+
+  // the block outlives all but its last model, wherever that went
+  value last = 1;
+  ASSERT_DEALLOCATIONS(0, xs.erase(xs.begin(), xs.begin() + 50));
+  ASSERT_DEALLOCATIONS(0, swap(last, xs.back()));
+  ASSERT_DEALLOCATIONS(0, xs.clear());
+  assert(*erasure::target<std::string>(last) == strings.back());
+  ASSERT_DEALLOCATIONS(1, last = value{});
+
+  // values that fit the buffer are placed inline
+  std::vector<int> ints{1, 2, 3};
+  ASSERT_ALLOCATIONS(0, (erasure::make_anys<regular, swappable,
+                                            buffer_size<16>>(ints.begin(),
+                                                             ints.end())));
+}
+
+void test_clone_range() {
+  using value = erasure::any<regular, buffer_size<16>>;
+  std::vector<value> src;
+  for (int i = 0; i < 10; ++i) {
+    src.push_back(value{i});
+    src.push_back(value{big{{i}}});
+    src.push_back(value{big{{i, i}}});
+    src.push_back(value{std::string(40, 's')});
+  }
+
+  std::vector<value> dst;
+  ASSERT_ALLOCATIONS(1, erasure::clone_range(src, dst));
+  assert(dst == src);
+  dst.clear();
+  // the ints are copied inline (10) and the strings copy constructed (10);
+  // the size of a spilled model is asked when its type differs from the one
+  // before, in both passes (2 x 20), and the bigs are copied with memcpy
+  ASSERT_DISPATCHES(60, erasure::clone_range(src, dst));
+  assert(dst == src);
+
+  // the copies stand on their own
+  src.clear();
+  assert(*erasure::target<big>(dst[5]) == (big{{1}}));
+  assert(*erasure::target<std::string>(dst[7]) == std::string(40, 's'));
+
+  // nothing that spills, nothing allocated
+  std::vector<value> small{value{1}, value{}}, copy;
+  ASSERT_ALLOCATIONS(0, erasure::clone_range(small, copy));
+  assert(copy[0] == small[0] && empty(copy[1]));
+}
+} // namespace
+
+int main() {
+  test_make_anys();
+  test_clone_range();
+}
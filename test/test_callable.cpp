@@ -14,16 +14,21 @@
  * limitations under the License.
  */
 
-#include "erasure/feature/callable.hpp"
-#include "erasure/feature/regular.hpp"
-
-#include "erasure/erasure.hpp"
-
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <string>
 #include <tuple>
 
+#ifdef ERASURE_TEST_MODULE
+import erasure;
+#else
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "erasure/erasure.hpp"
+#endif
+
 struct can_const_call {
   int operator()() const { return 1; }
   int operator()(int) const { return 2; }
@@ -74,7 +79,48 @@ void test_mutably_callable() {
   assert(x(1) == 1);
 }
 
+void test_any_returning_callable() {
+  using erasure::any;
+  using erasure::features::buffer_size;
+  using erasure::features::callable;
+  using erasure::features::function;
+  using erasure::features::regular;
+
+  using result = any<regular, buffer_size<16>>;
+  any<function<result(int)>> parse = [](int x) -> result {
+    if (x < 0) {
+      return result{std::string(32, '-')};
+    }
+    return result{x};
+  };
+  assert(parse(5) == result{5});
+  assert(parse(-1) == result{std::string(32, '-')});
+
+  // values of other types are made into a result
+  any<function<result(int)>> twice = [](int x) { return 2 * x; };
+  assert(twice(4) == result{8});
+  any<function<result()>> text = [] { return std::string(32, 'x'); };
+  assert(text() == result{std::string(32, 'x')});
+
+  auto counter = erasure::make_any<regular, callable<result()>>(
+      can_mutably_call{});
+  assert(counter() == result{1});
+  assert(counter() == result{2});
+
+  // results of the any type itself are moved or copied into place, so
+  // they need not be assignable
+  using inner = any<function<int()>>;
+  any<function<inner()>> make_inner = [] { return inner{[] { return 3; }}; };
+  assert(make_inner()() == 3);
+  inner const five = [] { return 5; };
+  any<function<inner()>> forward_inner = [&five]() -> inner const & {
+    return five;
+  };
+  assert(forward_inner()() == 5);
+}
+
 int main() {
   test_const_callable();
   test_mutably_callable();
+  test_any_returning_callable();
 }
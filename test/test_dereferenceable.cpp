@@ -14,14 +14,18 @@
  * limitations under the License.
  */
 
+#include <cassert>
+#include <memory>
+#include <tuple>
+
+#ifdef ERASURE_TEST_MODULE
+import erasure;
+#else
 #include "erasure/erasure.hpp"
 #include "erasure/feature/callable.hpp"
 #include "erasure/feature/dereferenceable.hpp"
 #include "erasure/feature/regular.hpp"
-
-#include <cassert>
-#include <memory>
-#include <tuple>
+#endif
 
 struct can_const_deref {
   int operator*() const { return 1; }
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Exchanges anys between two plugins, loaded with dlopen from the paths in
+ * argv[1] and argv[2], and this program.
+ */
+
+#include "dso_plugin.hpp"
+
+#include "erasure/feature/callable.hpp"
+#include "erasure/open_method.hpp"
+#include "erasure/type_hash.hpp"
+
+#include <dlfcn.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+using dso_test::point;
+using dso_test::value;
+
+struct plugin {
+  dso_test::make_fn *make;
+  dso_test::check_fn *check;
+};
+
+auto load(char const *path) -> plugin {
+  auto const handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    std::fprintf(stderr, "%s\n", dlerror());
+    std::abort();
+  }
+  // never closed: the anys made there need its code
+  return {reinterpret_cast<dso_test::make_fn *>(dlsym(handle, "dso_test_make")),
+          reinterpret_cast<dso_test::check_fn *>(
+              dlsym(handle, "dso_test_check"))};
+}
+
+static_assert(erasure::type_hash<point>() != erasure::type_hash<int>());
+static_assert(erasure::type_name<int>() == "int");
+static_assert(erasure::type_name<dso_test::point>() == "dso_test::point");
+
+// types whose names may be shared by other types have no hash
+struct unnamed_namespace {};
+auto const lambda = [] {};
+static_assert(erasure::has_type_hash<point> && erasure::has_type_hash<int>);
+static_assert(!erasure::has_type_hash<unnamed_namespace>);
+static_assert(!erasure::has_type_hash<decltype(lambda)>);
+
+} // namespace
+
+int main(int argc, char **argv) {
+  assert(argc == 3);
+  auto const a = load(argv[1]);
+  auto const b = load(argv[2]);
+  assert(a.make && a.check && b.make && b.check);
+
+  std::vector<value> from_a, from_b, here;
+  a.make(from_a, 1);
+  b.make(from_b, 2);
+  here.emplace_back(point{3, 2});
+
+  // the premise: each plugin has its own vtable for the same model
+  assert(!erasure::detail::same_vtable(from_a[0], from_b[0]));
+  assert(!erasure::detail::same_vtable(from_a[0], here[0]));
+
+  // the plugins recognize each other's anys
+  assert(b.check(from_a, 1));
+  assert(a.check(from_b, 2));
+
+  // and so does the program
+  for (auto const &x : {from_a[0], from_b[0]}) {
+    assert(same_dynamic_type(x, here[0]));
+    assert(erasure::target<point>(x) != nullptr);
+    assert(erasure::target<int>(x) == nullptr);
+  }
+  assert(from_a[2] == value{7} && value{7} == from_b[2]);
+  assert(from_a[1] == from_b[1]);
+  assert(!same_dynamic_type(from_a[1], from_b[2]));
+
+  // copies made here, by the plugin's code, are still the plugin's type
+  value copy = from_a[0];
+  assert(*erasure::target<point>(copy) == (point{1, 2}));
+
+  // an open method defined here works on the plugins' anys
+  erasure::open_method<int()> sum;
+  sum.define<point>([](point const &p) { return p.x + p.y; });
+  sum.define<int>([](int const &i) { return i; });
+  assert(sum(from_a[0]) == 3 && sum(from_b[0]) == 4 && sum(from_b[2]) == 7);
+
+  // two closures of one function have the same name, but not the same type
+  auto const one = [] { return 1; };
+  auto const two = [] { return 2; };
+  static_assert(erasure::type_name<decltype(one)>() ==
+                erasure::type_name<decltype(two)>());
+  using function = erasure::any<erasure::features::copyable,
+                                erasure::features::callable<int() const>>;
+  function const f = one, g = two;
+  assert(!same_dynamic_type(f, g));
+  assert(erasure::target<decltype(two)>(f) == nullptr);
+  assert(erasure::target<decltype(one)>(f) != nullptr);
+}
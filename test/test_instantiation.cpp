@@ -0,0 +1,54 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_instantiation.hpp"
+
+#include <cassert>
+#include <sstream>
+#include <utility>
+
+namespace {
+using test_instantiation::handle;
+using test_instantiation::shape;
+
+void test_extern_any() {
+  shape x = 5;
+  shape y = std::string("five");
+  shape z = x;
+  assert(z == x);
+  assert(!(z == y));
+
+  z = y;
+  assert(z == y);
+  assert(*erasure::target<std::string>(z) == "five");
+
+  std::ostringstream out;
+  out << x << ' ' << y;
+  assert(out.str() == "5 five");
+}
+
+void test_extern_move_only_model() {
+  // the model of a move-only type has no copy constructor to instantiate
+  handle x = std::make_unique<int>(3);
+  handle y = std::move(x);
+  assert(**erasure::target<std::unique_ptr<int>>(y) == 3);
+}
+} // namespace
+
+int main() {
+  test_extern_any();
+  test_extern_move_only_model();
+}
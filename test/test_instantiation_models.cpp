@@ -0,0 +1,24 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_instantiation.hpp"
+
+ERASURE_INSTANTIATE_ANY(erasure::any<erasure::features::regular,
+                                     erasure::features::ostreamable>);
+ERASURE_INSTANTIATE_MODEL(test_instantiation::shape, int);
+ERASURE_INSTANTIATE_MODEL(test_instantiation::shape, std::string);
+ERASURE_INSTANTIATE_ANY(test_instantiation::handle);
+ERASURE_INSTANTIATE_MODEL(test_instantiation::handle, std::unique_ptr<int>);
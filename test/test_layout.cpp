@@ -0,0 +1,143 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/regular.hpp"
+#include "erasure/feature/value_equality_comparable.hpp"
+#include "erasure/layout.hpp"
+
+#include "debug/layout_table.hpp"
+
+#include <array>
+#include <cassert>
+#include <sstream>
+#include <string>
+
+namespace {
+using erasure::layout;
+using erasure::layout_for;
+namespace features = erasure::features;
+
+using any24 = erasure::any<features::regular, features::buffer_size<24>>;
+using any30 = erasure::any<features::regular, features::buffer_size<30>>;
+using any40 = erasure::any<features::regular, features::buffer_size<40>>;
+using heap_any = erasure::any<features::movable>;
+
+template <std::size_t N>
+struct bytes {
+  std::array<char, N> data{};
+  friend auto operator==(bytes const &x, bytes const &y) -> bool {
+    return x.data == y.data;
+  }
+};
+
+struct alignas(16) over_aligned {
+  char c = 0;
+  friend auto operator==(over_aligned const &, over_aligned const &) -> bool {
+    return true;
+  }
+};
+
+// the handle
+static_assert(layout<any24>::handle_size == sizeof(any24));
+static_assert(layout<any24>::capacity == 24);
+static_assert(layout<any24>::value_capacity == 16);
+static_assert(layout<any30>::value_capacity == 16);
+static_assert(layout<heap_any>::capacity == 0);
+static_assert(layout<heap_any>::value_capacity == 0);
+
+// the features and their vtable slots: regular is move and copy
+// construction (two each), both assignments and ==
+static_assert(layout<any24>::features == 5);
+static_assert(layout<any24>::vtable_slots == 5 + 2 + 1 + 2 + 1 + 1);
+static_assert(layout<heap_any>::vtable_slots == 5 + 2 + 1);
+static_assert(layout<erasure::any<features::movable,
+                                  features::equality_comparable_with<int>>>::
+                  vtable_slots == layout<heap_any>::vtable_slots);
+
+// the models
+static_assert(layout_for<any24, bytes<16>>::model_size == 24);
+static_assert(layout_for<any24, bytes<16>>::fits_inline);
+static_assert(!layout_for<any24, bytes<17>>::fits_inline);
+static_assert(layout_for<any24, bytes<17>>::missing_bytes == 8);
+static_assert(layout_for<any24, int const &>::value_size == sizeof(int));
+static_assert(!layout_for<heap_any, char>::fits_inline);
+static_assert(layout_for<any30, bytes<16>>::fits_inline);
+static_assert(!layout_for<any30, bytes<17>>::fits_inline);
+
+// over-aligned models reserve room to align themselves
+static_assert(layout_for<any24, over_aligned>::model_size == 32);
+static_assert(layout_for<any24, over_aligned>::model_align == 16);
+static_assert(layout_for<any24, over_aligned>::footprint == 32 + 16 - 8);
+static_assert(layout_for<any24, over_aligned>::missing_bytes == 16);
+static_assert(layout_for<any40, over_aligned>::fits_inline);
+
+template <typename Any, typename T>
+void check_describe(T const &value) {
+  Any x = value;
+  auto const d = erasure::debug::describe(x);
+  assert(!d.empty);
+  assert(*d.value_type == typeid(T));
+  assert(d.handle_size == sizeof(Any));
+  assert(d.capacity == layout<Any>::capacity);
+  assert(d.model_size == (layout_for<Any, T>::model_size));
+  assert(d.model_align == (layout_for<Any, T>::model_align));
+  assert(d.vtable_slots == layout<Any>::vtable_slots);
+  assert(d.model_size == erasure::debug::model_size(x));
+  if (layout_for<Any, T>::fits_inline) {
+    assert(!d.on_heap);
+  }
+  if (layout_for<Any, T>::model_size > layout<Any>::capacity) {
+    assert(d.on_heap);
+  }
+}
+} // namespace
+
+int main() {
+  // describe() agrees with the compile-time layout
+  check_describe<any24>(1);
+  check_describe<any24>(bytes<16>{});
+  check_describe<any24>(bytes<17>{});
+  check_describe<any24>(std::string("layout"));
+  check_describe<any24>(over_aligned{});
+  check_describe<any40>(over_aligned{});
+  check_describe<any30>(bytes<16>{});
+  check_describe<any30>(bytes<20>{});
+  check_describe<heap_any>(1);
+
+  {
+    any24 x;
+    auto const d = erasure::debug::describe(x);
+    assert(d.empty);
+    assert(*d.value_type == typeid(void));
+    assert(d.model_size == 0);
+  }
+
+  {
+    using fn = erasure::any<features::function<int(int)>>;
+    static_assert(layout<fn>::capacity == 3 * sizeof(void *));
+    static_assert(layout<fn>::vtable_slots == 5 + 1 + 2 + 2);
+  }
+
+  {
+    std::ostringstream out;
+    dbg_util::print_layout_table<any24, int, bytes<17>>(out);
+    auto const table = out.str();
+    assert(table.find("handle 32 bytes, buffer 24 bytes") != std::string::npos);
+    assert(table.find("+8") != std::string::npos);
+  }
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/memoized.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void test_hits_skip_the_call() {
+  int calls = 0;
+  erasure::memoized<std::string(int, std::string)> join =
+      [&calls](int n, std::string const &s) {
+        ++calls;
+        std::string r;
+        for (int i = 0; i < n; ++i) {
+          r += s;
+        }
+        return r;
+      };
+  assert(join(3, "ab") == "ababab");
+  assert(join(2, "ab") == "abab");
+  assert(calls == 2);
+  std::string r;
+  ASSERT_DISPATCHES(0, r = join(3, "ab"));
+  assert(r == "ababab");
+  assert(calls == 2);
+
+  auto const stats = join.stats();
+  assert(stats.hits == 1 && stats.misses == 2 && stats.evictions == 0);
+  assert(stats.hit_rate() > 0.33 && stats.hit_rate() < 0.34);
+
+  join.clear();
+  assert(join(3, "ab") == "ababab");
+  assert(calls == 3);
+  assert(join.stats().misses == 1);
+}
+
+void test_hits_copy_no_arguments() {
+  erasure::memoized<std::size_t(std::string)> length =
+      [](std::string const &s) { return s.size(); };
+  erasure::sharded_memoized<std::size_t(std::string)> sharded_length =
+      [](std::string const &s) { return s.size(); };
+  std::string const s(100, 'x');
+  assert(length(s) == 100 && sharded_length(s) == 100);
+  std::size_t n = 0;
+  ASSERT_OPERATOR_NEWS(0, n = length(s));
+  ASSERT_OPERATOR_NEWS(0, n = sharded_length(s));
+  assert(n == 100);
+}
+
+void test_capacity_is_bounded() {
+  int calls = 0;
+  erasure::memoized<int(int), 8> square = [&calls](int x) {
+    ++calls;
+    return x * x;
+  };
+  for (int round = 0; round < 2; ++round) {
+    for (int x = 0; x < 100; ++x) {
+      assert(square(x) == x * x);
+    }
+  }
+  // 8 slots can't hold 100 results from one round to the next
+  assert(calls == 200);
+  assert(square.stats().evictions == 200 - 8);
+}
+
+/** Keys 0-7 in an 8 slot cache take all the slots. */
+template <typename Eviction>
+auto evicts_after_reuse(int hot) -> int {
+  erasure::memoized<int(int), 8, Eviction> id = [](int x) { return x; };
+  for (int x = 0; x < 8; ++x) {
+    id(x);
+  }
+  // key hot is used most often, key 0 most recently
+  for (int i = 0; i < 3; ++i) {
+    id(hot);
+  }
+  id(0);
+  id(100);
+  auto const before = id.stats().misses;
+  int evicted = -1;
+  for (int x = 0; x < 8; ++x) {
+    id(x);
+    if (id.stats().misses != before) {
+      evicted = x;
+      break;
+    }
+  }
+  return evicted;
+}
+
+void test_eviction_policies() {
+  // key 1 has gone unused the longest
+  assert(evicts_after_reuse<erasure::evict_least_recent>(5) == 1);
+  // one of those used once goes, not hot or 0
+  auto const lfu = evicts_after_reuse<erasure::evict_least_frequent>(1);
+  assert(lfu >= 2 && lfu <= 7);
+}
+
+void test_sharded() {
+  std::atomic<int> calls{0};
+  erasure::sharded_memoized<long(int), 4, 64> cube = [&calls](int x) {
+    ++calls;
+    return static_cast<long>(x) * x * x;
+  };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 1000; ++i) {
+        auto const x = i % 32;
+        assert(cube(x) == static_cast<long>(x) * x * x);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  auto const stats = cube.stats();
+  assert(stats.hits + stats.misses == 4000);
+  // every key is computed at least once, and rarely more often
+  assert(calls >= 32 && static_cast<std::uint64_t>(calls) == stats.misses);
+  assert(stats.hit_rate() > 0.9);
+}
+
+} // namespace
+
+DBG_UTIL_COUNT_OPERATOR_NEW()
+
+int main() {
+  test_hits_skip_the_call();
+  test_hits_copy_no_arguments();
+  test_capacity_is_bounded();
+  test_eviction_policies();
+  test_sharded();
+}
@@ -44,6 +44,30 @@ void test_concatenate() {
                 "");
 }
 
+struct keyed {
+  static constexpr std::string_view sort_key = "a";
+};
+
+void test_sort_by_name() {
+  using sorted = erm::sort_by_name_t<erm::typelist<int, long, char>>;
+  static_assert(erm::len<sorted>{} == 3, "Sorting keeps every element.");
+  static_assert(erm::is_subset_of_t<erm::typelist<int, long, char>, sorted>{},
+                "Sorting keeps every element.");
+  static_assert(
+      sorted{} == erm::sort_by_name_t<erm::typelist<char, long, int>>{},
+      "Permutations sort the same.");
+  static_assert(sorted{} == erm::sort_by_name_t<sorted>{},
+                "A sorted list stays sorted.");
+  static_assert(erm::typelist<int, int>{} ==
+                    erm::sort_by_name_t<erm::typelist<int, int>>{},
+                "Duplicates are kept.");
+
+  static_assert(erm::sort_name<keyed>() == "a");
+  static_assert(erm::typelist<keyed, char, int>{} ==
+                    erm::sort_by_name_t<erm::typelist<int, keyed, char>>{},
+                "A sort_key replaces the type's name.");
+}
+
 namespace test_forward_cast {
 struct sx {};
 struct sy : sx {};
@@ -71,4 +95,5 @@ int main() {
   test_cons();
   test_take_1_t();
   test_concatenate();
+  test_sort_by_name();
 }
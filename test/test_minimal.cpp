@@ -1,5 +1,9 @@
+#ifdef ERASURE_TEST_MODULE
+import erasure;
+#else
 #include "erasure/erasure.hpp"
 #include "erasure/feature/regular.hpp"
+#endif
 
 int main() {
   using erasure::any;
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+#include "erasure/open_method.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <cassert>
+#include <string>
+
+// open_methods need types with external linkage
+namespace open_method_test {
+struct circle {
+  double r;
+  friend auto operator==(circle const &, circle const &) -> bool = default;
+};
+struct square {
+  double side;
+  friend auto operator==(square const &, square const &) -> bool = default;
+};
+struct blob {
+  friend auto operator==(blob const &, blob const &) -> bool = default;
+};
+} // namespace open_method_test
+
+namespace {
+namespace features = erasure::features;
+using open_method_test::blob;
+using open_method_test::circle;
+using open_method_test::square;
+
+auto circle_area(circle const &c) -> double { return 3 * c.r * c.r; }
+
+erasure::open_method<double()> area;
+// defined while initializing statics
+bool const area_defined =
+    (area.define<circle, &circle_area>(),
+     area.define<square>([](square const &s) { return s.side * s.side; }),
+     true);
+
+void test_calls() {
+  using shape = erasure::any<features::regular>;
+  shape c = circle{2};
+  shape s = square{3};
+  assert(area(c) == 12);
+  assert(area(s) == 9);
+  // one call through the vtable, for the value and its type
+  double a = 0;
+  ASSERT_DISPATCHES(1, a = area(c));
+  assert(a == 12);
+
+  // any any type works, and so do values in its small buffer
+  using small_shape = erasure::any<features::regular, features::buffer_size<16>>;
+  assert(area(small_shape{square{2}}) == 4);
+}
+
+void test_arguments() {
+  erasure::open_method<std::string(std::string const &, int)> describe;
+  describe.define<int>([](int const &x, std::string const &prefix, int n) {
+    return prefix + std::to_string(x * n);
+  });
+  erasure::any<features::regular> x = 7;
+  assert(describe(x, "n=", 3) == "n=21");
+}
+
+void test_missing() {
+  using shape = erasure::any<features::regular>;
+  assert(area.defines<circle>() && !area.defines<blob>());
+  assert(area.defines(shape{circle{1}}) && !area.defines(shape{blob{}}));
+  assert(!area.defines(shape{}));
+
+  auto threw = [](shape const &x) {
+    try {
+      area(x);
+    } catch (erasure::bad_open_method_call const &e) {
+      return std::string(e.what());
+    }
+    return std::string();
+  };
+  // the message names the type
+  auto const missing = threw(shape{blob{}});
+  assert(missing.find("open_method_test::blob") != std::string::npos);
+  assert(!threw(shape{}).empty());
+
+  // later definitions replace earlier ones
+  area.define<blob>([](blob const &) { return 1.0; });
+  assert(area(shape{blob{}}) == 1);
+  area.define<blob>([](blob const &) { return 2.0; });
+  assert(area(shape{blob{}}) == 2);
+}
+
+} // namespace
+
+int main() {
+  assert(area_defined);
+  test_calls();
+  test_arguments();
+  test_missing();
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/feature/regular.hpp"
+#include "erasure/persistent_vector.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using dbg_util::instrumented;
+using value = erasure::any<erasure::features::regular>;
+using values = erasure::persistent_any_vector<value>;
+
+auto int_at(values const &v, std::size_t i) -> int {
+  return *erasure::target<int>(v[i]);
+}
+
+/** Checks v against the ints it should hold, through every way to read. */
+void check(values const &v, std::vector<int> const &expected) {
+  assert(v.size() == expected.size());
+  assert(v.empty() == expected.empty());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    assert(int_at(v, i) == expected[i]);
+  }
+  std::size_t i = 0;
+  for (auto const &x : v) {
+    assert(*erasure::target<int>(x) == expected[i++]);
+  }
+  assert(i == expected.size());
+  i = 0;
+  v.for_each_chunk([&](std::span<value const> chunk) {
+    // only the last chunk isn't full
+    assert(chunk.size() == values::chunk_size ||
+           i + chunk.size() == expected.size());
+    for (auto const &x : chunk) {
+      assert(*erasure::target<int>(x) == expected[i++]);
+    }
+  });
+  assert(i == expected.size());
+}
+
+void test_grows_and_shrinks_through_levels() {
+  // 32 fit in the tail, 1024 under one root, 32768 under two levels
+  constexpr int n = 40000;
+  std::vector<values> versions{values{}};
+  std::vector<int> expected;
+  for (int i = 0; i < n; ++i) {
+    versions.push_back(versions.back().push_back(i));
+  }
+  for (int i = 0; i <= n; i += 997) {
+    expected.resize(static_cast<std::size_t>(i));
+    for (int j = 0; j < i; ++j) {
+      expected[static_cast<std::size_t>(j)] = j;
+    }
+    check(versions[static_cast<std::size_t>(i)], expected);
+  }
+  auto v = versions.back();
+  for (int i = n; i > 0; --i) {
+    v = v.pop_back();
+    assert(v.size() == static_cast<std::size_t>(i - 1));
+    if (i % 331 == 0 || i < 40) {
+      expected.resize(static_cast<std::size_t>(i - 1));
+      check(v, expected);
+    }
+  }
+  assert(v.empty());
+  // popping left the versions it came from as they were
+  expected.resize(n);
+  for (int j = 0; j < n; ++j) {
+    expected[static_cast<std::size_t>(j)] = j;
+  }
+  check(versions.back(), expected);
+}
+
+void test_set_leaves_other_versions() {
+  values v;
+  std::vector<int> expected;
+  for (int i = 0; i < 3000; ++i) {
+    v = std::move(v).push_back(i);
+    expected.push_back(i);
+  }
+  auto const before = v;
+  auto const after = v.set(5, 500).set(1500, 1).set(2999, 7);
+  check(before, expected);
+  auto changed = expected;
+  changed[5] = 500;
+  changed[1500] = 1;
+  changed[2999] = 7;
+  check(after, changed);
+  // the other chunks are shared, not copied
+  assert(&before[100] == &after[100]);
+  assert(&before[6] != &after[6]);
+}
+
+void test_snapshots_copy_no_values() {
+  erasure::transient_any_vector<value> t;
+  for (int i = 0; i < 2000; ++i) {
+    t.push_back(instrumented<int>{i});
+  }
+  auto const v = std::move(t).persistent();
+  assert(t.empty());
+
+  dbg_util::clear_trace();
+  erasure::persistent_any_vector<value> snapshot, edited, grown;
+  ASSERT_OPERATIONS(0, snapshot = v);
+  ASSERT_OPERATOR_NEWS(0, snapshot = v);
+  // one chunk of 32 copied, and one value assigned into it
+  ASSERT_OPERATIONS(32 + 1, edited = v.set(10, v[11]));
+  // the tail holds 2000 - 1984 = 16
+  ASSERT_OPERATIONS(16 + 1, grown = v.push_back(v[0]));
+}
+
+void test_transient_edits_in_place() {
+  erasure::transient_any_vector<value> build;
+  for (int i = 0; i < 2000; ++i) {
+    build.push_back(instrumented<int>{i});
+  }
+  auto const v = std::move(build).persistent();
+
+  dbg_util::clear_trace();
+  auto t = v.transient();
+  value const x = instrumented<int>{-1};
+  // the first edit of a chunk copies it, the rest don't
+  ASSERT_OPERATIONS(32 + 1, t.set(10, x));
+  ASSERT_OPERATIONS(1, t.set(11, x));
+  ASSERT_OPERATOR_NEWS(0, t.set(12, x));
+  ASSERT_OPERATIONS(16 + 1, t.push_back(x));
+  ASSERT_OPERATIONS(1, t.push_back(x));
+  ASSERT_OPERATOR_NEWS(0, t.push_back(x));
+  assert(t.size() == 2003);
+  auto const edited = std::move(t).persistent();
+  assert(erasure::target<instrumented<int>>(edited[12])->value == -1);
+  assert(erasure::target<instrumented<int>>(v[12])->value == 12);
+  assert(v.size() == 2000);
+}
+
+void test_versions_on_many_threads() {
+  values v;
+  for (int i = 0; i < 5000; ++i) {
+    v = std::move(v).push_back(i);
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([v, t] {
+      auto mine = v;
+      for (int i = 0; i < 1000; ++i) {
+        mine = mine.set(static_cast<std::size_t>(i * 5), t).push_back(t);
+      }
+      assert(int_at(mine, 0) == t && int_at(mine, 1) == 1);
+      assert(int_at(v, 0) == 0);
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  assert(int_at(v, 0) == 0 && v.size() == 5000);
+}
+
+void test_holds_any_values() {
+  auto v = values{}.push_back(1).push_back(std::string(100, 'x')).push_back(
+      value{});
+  assert(*erasure::target<std::string>(v[1]) == std::string(100, 'x'));
+  assert(empty(v[2]));
+  auto const w = v.set(2, std::string("y"));
+  assert(empty(v[2]));
+  assert(*erasure::target<std::string>(w[2]) == "y");
+}
+} // namespace
+
+DBG_UTIL_COUNT_OPERATOR_NEW()
+
+int main() {
+  test_grows_and_shrinks_through_levels();
+  test_set_leaves_other_versions();
+  test_snapshots_copy_no_values();
+  test_transient_edits_in_place();
+  test_versions_on_many_threads();
+  test_holds_any_values();
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/pointer_like.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/allocation_tracker.hpp"
+
+#include <cassert>
+#include <memory>
+#include <utility>
+
+namespace {
+namespace features = erasure::features;
+using erasure::any;
+using features::pointer_like;
+
+struct point {
+  int x, y;
+};
+
+void test_raw_and_smart_pointers() {
+  point target{1, 2};
+  any<features::regular, pointer_like<point>> raw = &target;
+  assert(raw.get() == &target);
+  assert(raw->y == 2);
+  raw->x = 3;
+  assert(target.x == 3);
+
+  any<features::movable, pointer_like<point>> unique =
+      std::make_unique<point>(point{4, 5});
+  assert((*unique).x == 4);
+
+  auto shared = std::make_shared<point>(point{6, 7});
+  any<features::regular, pointer_like<point>> copy = shared;
+  assert(copy.get() == shared.get());
+
+  any<features::movable, pointer_like<point>> empty;
+  assert(empty.get() == nullptr);
+}
+
+void test_dereference_does_not_dispatch() {
+  any<features::movable, pointer_like<point>> p =
+      std::make_unique<point>(point{1, 2});
+  int x = 0;
+  ASSERT_DISPATCHES(0, x = (*p).x);
+  ASSERT_DISPATCHES(0, x = p->y);
+  ASSERT_DISPATCHES(0, x = p.get()->x);
+  (void)x;
+}
+
+void test_cache_follows_mutations() {
+  using handle = any<features::regular, features::swappable,
+                     pointer_like<point>>;
+  auto first = std::make_shared<point>(point{1, 0});
+  auto second = std::make_shared<point>(point{2, 0});
+
+  handle a = first;
+  handle b = a;
+  assert(b.get() == first.get());
+
+  // assigning a value of the same type assigns in place
+  b = handle{second};
+  assert(b.get() == second.get());
+
+  b = handle{first.get()};
+  assert(b.get() == first.get());
+
+  swap(a, b);
+  assert(a.get() == first.get() && b.get() == first.get());
+  a = handle{second};
+  swap(a, b);
+  assert(a.get() == first.get() && b.get() == second.get());
+
+  a = b;
+  assert(a.get() == second.get());
+
+  // a moved-from smart pointer is null, and so is the cache
+  any<features::movable, pointer_like<point>> u =
+      std::make_unique<point>(point{3, 0});
+  auto const pointee = u.get();
+  auto v = std::move(u);
+  assert(v.get() == pointee);
+  assert(u.get() == nullptr);
+  u = std::move(v);
+  assert(u.get() == pointee && v.get() == nullptr);
+}
+
+void test_follows_changes_in_place() {
+  point first{1, 0}, second{2, 0};
+  any<features::regular, pointer_like<point>> raw = &first;
+  *erasure::target<point *>(raw) = &second;
+  assert(raw.get() == &second && raw->x == 2);
+
+  any<features::movable, pointer_like<point>> unique =
+      std::make_unique<point>(point{3, 0});
+  erasure::target<std::unique_ptr<point>>(unique)->reset(new point{4, 0});
+  assert((*unique).x == 4);
+  erasure::target<std::unique_ptr<point>>(unique)->reset();
+  assert(unique.get() == nullptr);
+}
+} // namespace
+
+int main() {
+  test_raw_and_smart_pointers();
+  test_dereference_does_not_dispatch();
+  test_cache_follows_mutations();
+  test_follows_changes_in_place();
+}
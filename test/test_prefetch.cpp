@@ -0,0 +1,92 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+#include "erasure/prefetch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace {
+using value = erasure::any<erasure::features::regular>;
+
+auto make_values(int n) -> std::vector<value> {
+  std::vector<value> xs;
+  for (int i = 0; i < n; ++i) {
+    if (i % 3 == 0) {
+      xs.emplace_back(std::to_string(i));
+    } else if (i % 3 == 1) {
+      xs.emplace_back(i);
+    } else {
+      xs.emplace_back();
+    }
+  }
+  return xs;
+}
+
+/** Checks that fn saw every element once, in order. */
+void check_visits(std::vector<value> const &xs, std::size_t distance) {
+  std::vector<value const *> seen;
+  auto const used = erasure::for_each_prefetched(
+      xs, [&](value const &x) { seen.push_back(&x); }, distance);
+  assert(seen.size() == xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    assert(seen[i] == &xs[i]);
+  }
+  if (distance != erasure::auto_prefetch_distance) {
+    assert(used == distance);
+  }
+}
+
+void test_visits_in_order() {
+  for (auto const n : {0, 1, 5, 100, 50000}) {
+    auto const xs = make_values(n);
+    for (auto const distance : {std::size_t{1}, std::size_t{16},
+                                std::size_t{1000},
+                                erasure::auto_prefetch_distance}) {
+      check_visits(xs, distance);
+    }
+  }
+}
+
+void test_auto_distance() {
+  // too short to tune
+  auto const few = make_values(100);
+  assert(erasure::for_each_prefetched(few, [](value const &) {}) == 16);
+  // long enough: one of the candidates
+  auto const many = make_values(50000);
+  auto const d = erasure::for_each_prefetched(many, [](value const &) {});
+  assert(std::find(erasure::detail::prefetch_candidates.begin(),
+                   erasure::detail::prefetch_candidates.end(),
+                   d) != erasure::detail::prefetch_candidates.end());
+}
+
+void test_mutable_visit() {
+  auto xs = make_values(10);
+  erasure::for_each_prefetched(xs, [](value &x) { x = value{}; }, 4);
+  assert(std::all_of(xs.begin(), xs.end(),
+                     [](value const &x) { return empty(x); }));
+}
+} // namespace
+
+int main() {
+  test_visits_in_order();
+  test_auto_distance();
+  test_mutable_visit();
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/callable.hpp"
+#include "erasure/feature/profiled.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include <cassert>
+#include <type_traits>
+
+#ifdef ERASURE_ENABLE_PROFILING
+#include "debug/profile.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+#endif
+
+namespace f = erasure::features;
+
+using profiled_function = erasure::any<f::profiled<f::function<int(int)>>>;
+
+struct add_one {
+  auto operator()(int x) const -> int { return x + 1; }
+};
+struct twice {
+  auto operator()(int x) const -> int { return 2 * x; }
+};
+
+#ifndef ERASURE_ENABLE_PROFILING
+// disabled, profiled<F> is F
+static_assert(std::is_same_v<profiled_function,
+                             erasure::any<f::function<int(int)>>>);
+static_assert(std::is_same_v<erasure::any<f::profiled<f::regular>>,
+                             erasure::any<f::regular>>);
+
+int main() {
+  profiled_function fn = add_one{};
+  assert(fn(1) == 2);
+}
+#else
+namespace {
+auto site_of(std::type_info const &value)
+    -> erasure::profiling::call_site const * {
+  static std::vector<erasure::profiling::call_site> sites;
+  sites = erasure::profiling::snapshot();
+  for (auto const &site : sites) {
+    if (*site.value == value) {
+      return &site;
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+int main() {
+  namespace profiling = erasure::profiling;
+
+  // calls are counted per dynamic type
+  {
+    profiled_function x = add_one{};
+    profiled_function y = twice{};
+    int r = 0;
+    for (int i = 0; i < 10; ++i) {
+      r += x(i);
+    }
+    r += y(r);
+    assert(r == 55 + 110);
+    assert(site_of(typeid(add_one))->calls == 10);
+    assert(site_of(typeid(twice))->calls == 1);
+    assert(*site_of(typeid(twice))->feature ==
+           typeid(f::callable<int(int)>));
+  }
+
+  // every period-th call is timed
+  {
+    profiling::set_sample_period(1);
+    assert(profiling::sample_period() == 1);
+    profiled_function x = [](int v) { return v; };
+    for (int i = 0; i < 8; ++i) {
+      x(i);
+    }
+    profiling::set_sample_period(5);
+    assert(profiling::sample_period() == 8);
+    profiling::set_sample_period(0);
+    assert(profiling::sample_period() == 0);
+    for (int i = 0; i < 64; ++i) {
+      x(i);
+    }
+    profiling::set_sample_period(1024);
+
+    auto const sites = profiling::snapshot();
+    auto const it =
+        std::find_if(sites.begin(), sites.end(), [](auto const &site) {
+          return site.calls == 72;
+        });
+    assert(it != sites.end());
+    assert(it->sampled_calls == 8);
+  }
+
+  // counts of exited threads are kept
+  {
+    struct from_thread {
+      auto operator()(int x) const -> int { return x; }
+    };
+    std::thread t{[] {
+      profiled_function x = from_thread{};
+      for (int i = 0; i < 3; ++i) {
+        x(i);
+      }
+    }};
+    t.join();
+    profiled_function x = from_thread{};
+    x(0);
+    assert(site_of(typeid(from_thread))->calls == 4);
+  }
+
+  // features of a profiled set are profiled one by one
+  {
+    using any_regular = erasure::any<f::profiled<f::regular>>;
+    any_regular a = std::string("a");
+    any_regular b = std::string("b");
+    assert(a != b);
+    assert(a == a);
+    auto const site = site_of(typeid(std::string));
+    assert(site && site->calls == 2);
+    assert(*site->feature == typeid(f::equality_comparable));
+  }
+
+  // the report names the types
+  {
+    std::ostringstream out;
+    dbg_util::print_profile(out);
+    assert(out.str().find("add_one: 10 calls") != std::string::npos);
+    assert(out.str().find("equality_comparable on std::string: 2 calls") !=
+           std::string::npos);
+  }
+}
+#endif
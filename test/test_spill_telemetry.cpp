@@ -0,0 +1,106 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/spill_report.hpp"
+
+#include <array>
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+namespace {
+using small_any = erasure::any<erasure::features::regular,
+                               erasure::features::buffer_size<16>>;
+
+struct big {
+  std::array<char, 40> bytes{};
+  friend auto operator==(big const &x, big const &y) -> bool {
+    return x.bytes == y.bytes;
+  }
+};
+
+auto site_of(std::type_info const &value)
+    -> erasure::telemetry::site_report {
+  for (auto const &s : erasure::telemetry::report()) {
+    if (*s.value_type == value) {
+      return s;
+    }
+  }
+  assert(false && "no such site");
+  return {};
+}
+} // namespace
+
+int main() {
+  namespace telemetry = erasure::telemetry;
+
+  // placements are counted per (any type, value type)
+  {
+    small_any a = 5;
+    small_any b = a;
+    small_any c = big{};
+    small_any d = c;
+    (void)b;
+    (void)d;
+
+    auto const ints = site_of(typeid(int));
+    assert(*ints.any_type == typeid(small_any));
+    assert(ints.inline_placements == 2);
+    assert(ints.heap_placements == 0);
+    assert(ints.capacity == 16);
+    assert(ints.missing_bytes() == 0);
+
+    auto const bigs = site_of(typeid(big));
+    assert(bigs.inline_placements == 0);
+    assert(bigs.heap_placements == 2);
+    assert(bigs.model_size == sizeof(void *) + sizeof(big));
+    assert(bigs.missing_bytes() == bigs.model_size - 16);
+
+    // the most spilling type comes first
+    assert(*telemetry::report().front().value_type == typeid(big));
+  }
+
+  // placements of exited threads are kept
+  {
+    std::thread t{[] { small_any x = big{}; }};
+    t.join();
+    assert(site_of(typeid(big)).heap_placements == 3);
+  }
+
+  // the histogram buckets models by size
+  {
+    auto const histogram = telemetry::size_histogram();
+    assert(histogram.size() == 4); // 8, 16, 32, 64
+    assert(histogram[1].inline_placements == 2);
+    assert(histogram[3].heap_placements == 3);
+  }
+
+  // the report names the types and can be reset
+  {
+    std::ostringstream out;
+    dbg_util::print_spill_report(out);
+    assert(out.str().find("big in ") != std::string::npos);
+    assert(out.str().find("3 on heap, 0 inline") != std::string::npos);
+
+    telemetry::reset();
+    assert(site_of(typeid(big)).heap_placements == 0);
+  }
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/instrumented.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+int main() {
+  using dbg_util::instrumented;
+  using dbg_util::operation;
+  using std::make_tuple;
+
+  // single-threaded traces read as before
+  {
+    dbg_util::clear_trace();
+    dbg_util::reset_numbering();
+    instrumented<int> x{5};
+    instrumented<int> y = x;
+    ASSERT_AND_CLEAR_TRACE_IS(make_tuple(0, -1, operation::VALUE_CONSTRUCTION),
+                              make_tuple(1, 0, operation::COPY_CONSTRUCTION));
+  }
+  dbg_util::clear_trace();
+
+  // every thread's records stay in order, and none are lost
+  {
+    constexpr int threads = 4;
+    constexpr int copies = 1000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([] {
+        erasure::any<erasure::features::regular> x = instrumented<int>{1};
+        for (int i = 0; i < copies; ++i) {
+          auto y = x;
+        }
+      });
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+    auto const records = dbg_util::trace_records();
+    std::set<std::uint32_t> seen_threads;
+    std::vector<std::uint64_t> last_id(64, 0);
+    std::size_t copy_constructions = 0;
+    for (auto const &r : records) {
+      seen_threads.insert(r.thread);
+      if (r.op == operation::COPY_CONSTRUCTION) {
+        // copies were recorded in order
+        assert(r.id > last_id[r.thread]);
+        last_id[r.thread] = r.id;
+        ++copy_constructions;
+      }
+    }
+    assert(seen_threads.size() == threads);
+    assert(copy_constructions == threads * copies);
+    // ids are unique over all threads
+    std::set<std::uint64_t> constructed;
+    for (auto const &r : records) {
+      if (r.op == operation::COPY_CONSTRUCTION) {
+        assert(constructed.insert(r.id).second);
+      }
+    }
+  }
+
+  // the export holds one event per record
+  {
+    std::ostringstream out;
+    auto const records = dbg_util::trace_records();
+    dbg_util::write_chrome_trace(out, records);
+    auto const json = out.str();
+    assert(json.find("{\"traceEvents\":[") == 0);
+    std::size_t events = 0;
+    for (auto at = json.find("\"ph\":\"i\""); at != std::string::npos;
+         at = json.find("\"ph\":\"i\"", at + 1)) {
+      ++events;
+    }
+    assert(events == records.size());
+    assert(json.find("\"name\":\"COPY_CONSTRUCTION\"") != std::string::npos);
+    assert(json.find("\"type\":\"int\"") != std::string::npos);
+  }
+
+  // clearing discards the records of all threads
+  {
+    dbg_util::clear_trace();
+    assert(dbg_util::trace_records().empty());
+  }
+
+  // full rings keep their newest records
+  {
+    dbg_util::set_trace_capacity(6); // rounds up to 8
+    std::thread t{[] {
+      for (int i = 0; i < 10; ++i) {
+        instrumented<int> x{i};
+      }
+    }};
+    t.join();
+    auto const records = dbg_util::trace_records();
+    assert(records.size() == 8);
+    assert(records.back().op == operation::DESTRUCTION);
+    assert(records.front().id + 3 == records.back().id);
+  }
+
+  // threads that start after others exited take over their rings
+  {
+    auto const &registry = dbg_util::detail::trace_registry_<>;
+    auto const rings = registry.rings.size();
+    for (int i = 0; i < 3; ++i) {
+      std::thread t{[] { instrumented<int> x{1}; }};
+      t.join();
+    }
+    assert(registry.rings.size() == rings);
+    // the records of the exited threads are kept
+    std::set<std::uint32_t> seen_threads;
+    for (auto const &r : dbg_util::trace_records()) {
+      seen_threads.insert(r.thread);
+    }
+    assert(seen_threads.size() == 4);
+  }
+
+  // reading while another thread records sees only whole records
+  {
+    dbg_util::clear_trace();
+    std::thread t{[] {
+      for (int i = 0; i < 20000; ++i) {
+        instrumented<int> x{i};
+      }
+    }};
+    for (int i = 0; i < 50; ++i) {
+      for (auto const &r : dbg_util::trace_records()) {
+        assert(r.op == operation::VALUE_CONSTRUCTION ||
+               r.op == operation::DESTRUCTION);
+        assert(r.type != nullptr);
+      }
+    }
+    t.join();
+  }
+}
@@ -100,4 +100,18 @@ int main() {
     auto x3 =
         make_any<move_constructible, copy_assignable>(instrumented<int>{5});
   }
+
+  // the order of the features does not matter
+  {
+    static_assert(std::is_same_v<any<move_assignable, move_constructible>,
+                                 any<move_constructible, move_assignable>>);
+    static_assert(std::is_same_v<any<movable>,
+                                 any<move_assignable, move_constructible>>);
+    static_assert(std::is_same_v<any<copyable, movable>,
+                                 any<movable, erasure::meta::typelist<>,
+                                     copy_assignable, copyable>>);
+
+    any<move_constructible, move_assignable> x{5};
+    any<move_assignable, move_constructible> y = std::move(x);
+  }
 }
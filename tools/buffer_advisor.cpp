@@ -0,0 +1,76 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Recommends buffer sizes from spill profiles (see debug/buffer_advisor.hpp).
+ *
+ *     buffer_advisor [--weight=B] [--header=FILE] [--namespace=NS] PROFILE...
+ *
+ * --weight is how many handle bytes one heap allocation is worth (default
+ * 64). With --header, writes the buffer_size aliases of the named any types
+ * to FILE, in namespace NS (default buffer_sizes).
+ */
+
+#include "debug/buffer_advisor.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+  double weight = 64;
+  std::string header;
+  std::string ns = "buffer_sizes";
+  std::vector<dbg_util::profile_entry> entries;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    auto const value = arg.substr(arg.find('=') + 1);
+    if (arg.rfind("--weight=", 0) == 0) {
+      weight = std::stod(value);
+    } else if (arg.rfind("--header=", 0) == 0) {
+      header = value;
+    } else if (arg.rfind("--namespace=", 0) == 0) {
+      ns = value;
+    } else {
+      std::ifstream in(arg);
+      if (!dbg_util::read_spill_profile(in, entries)) {
+        std::cerr << arg << ": not a spill profile\n";
+        return 1;
+      }
+    }
+  }
+  if (entries.empty()) {
+    std::cerr << "usage: " << argv[0]
+              << " [--weight=B] [--header=FILE] [--namespace=NS] PROFILE...\n";
+    return 1;
+  }
+
+  auto const advice = dbg_util::advise_buffer_sizes(entries, weight);
+  for (auto const &a : advice) {
+    std::cout << (a.name.empty() ? a.any_type : a.name) << "\n"
+              << "  " << a.placements << " placements; buffer " << a.capacity
+              << " -> " << a.advised_capacity << " bytes, heap placements "
+              << a.heap_placements << " -> " << a.advised_heap_placements
+              << ", cost " << std::fixed << std::setprecision(0) << a.cost
+              << " -> " << a.advised_cost << "\n";
+  }
+  if (!header.empty()) {
+    std::ofstream out(header);
+    dbg_util::write_buffer_size_header(out, advice, ns, weight);
+  }
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2015, 2016 Gašper Ažman
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Prints the layout of common value types in anys whose handles fill a
+ * quarter, half and whole 64-byte cache line.
+ *
+ * To size a buffer for your own types, add them to the list in print() below, or
+ * call dbg_util::print_layout_table<YourAny, YourTypes...> in your code.
+ */
+
+#include "erasure/erasure.hpp"
+#include "erasure/feature/regular.hpp"
+
+#include "debug/layout_table.hpp"
+
+#include <array>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <std::size_t BufferSize>
+using regular_any = erasure::any<erasure::features::regular,
+                                 erasure::features::buffer_size<BufferSize>>;
+
+template <typename Any>
+void print(std::ostream &o) {
+  dbg_util::print_layout_table<
+      Any, char, int, double, void *, std::pair<double, double>,
+      std::shared_ptr<int>, std::string, std::vector<int>,
+      std::map<int, int>, std::array<char, 32>,
+      std::array<char, 64>>(o);
+  o << "\n";
+}
+
+} // namespace
+
+int main() {
+  print<regular_any<8>>(std::cout);
+  print<regular_any<24>>(std::cout);
+  print<regular_any<56>>(std::cout);
+}